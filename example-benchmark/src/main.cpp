@@ -0,0 +1,26 @@
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+// headless: no window and no GL context are created.
+// usage: example-benchmark [--quick] [--out file.json] [--only name[,name...]]
+int main(int argc, char* argv[]){
+    auto app = make_shared<ofApp>();
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if (arg == "--quick"){
+            app->bQuick = true;
+        } else if (arg == "--out" && i + 1 < argc){
+            app->myOutputPath = argv[++i];
+        } else if (arg == "--only" && i + 1 < argc){
+            app->myFilter = ofSplitString(argv[++i], ",", true, true);
+        } else {
+            cerr << "unknown argument '" << arg << "'!\n";
+            return 1;
+        }
+    }
+
+    auto window = make_shared<ofAppNoWindow>();
+    ofRunApp(window, app);
+    return ofRunMainLoop();
+}
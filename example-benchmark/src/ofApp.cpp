@@ -0,0 +1,433 @@
+#include "ofApp.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+// the float loop readLinear ran before the fixed-point kernels. it isn't inlined,
+// so like the kernels it only gets the weight at run time.
+#ifdef _MSC_VER
+__declspec(noinline)
+#else
+__attribute__((noinline))
+#endif
+static void lerpGeneric(const unsigned char* pix1, const unsigned char* pix2, unsigned char* result, size_t size, float weight){
+    float a = 1 - weight;
+    float b = weight;
+    for (size_t i = 0; i < size; ++i){
+        result[i] = static_cast<unsigned char>(pix1[i] * a + pix2[i] * b);
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+    myMinTime = bQuick ? 0.05 : 0.25;
+    myMaxIterations = bQuick ? 200 : 2000;
+
+    struct Resolution {
+        string label;
+        int width;
+        int height;
+    };
+    vector<Resolution> resolutions = {
+        {"SD", 720, 576},
+        {"1080p", 1920, 1080},
+        {"4K", 3840, 2160}
+    };
+
+    for (auto& res : resolutions){
+        for (int channels : {1, 3, 4}){
+            runResolution(res.label, res.width, res.height, channels);
+        }
+    }
+
+    string json = toJson();
+    // stdout only carries the JSON document, progress goes to stderr
+    cout << json;
+    if (!myOutputPath.empty()){
+        ofstream file(myOutputPath);
+        if (file){
+            file << json;
+        } else {
+            cerr << "couldn't write " << myOutputPath << "!\n";
+        }
+    }
+
+    ofExit(0);
+}
+
+//--------------------------------------------------------------
+bool ofApp::isEnabled(const string& name) const {
+    if (myFilter.empty()){
+        return true;
+    }
+    for (auto& f : myFilter){
+        // "buffer" enables "buffer.write", "buffer.read" etc.
+        if (name == f || name.compare(0, f.size() + 1, f + ".") == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+//--------------------------------------------------------------
+void ofApp::runResolution(const string& label, int width, int height, int channels){
+    size_t frameSize = (size_t)width * height * channels;
+    // keep every buffer at about 256 MB
+    int frames = ofClamp((256 << 20) / frameSize, 4, 32);
+
+    myCurrent.resolution = label;
+    myCurrent.width = width;
+    myCurrent.height = height;
+    myCurrent.channels = channels;
+    myCurrent.frames = frames;
+
+    ofPixels source;
+    source.allocate(width, height, channels);
+    unsigned char* data = source.getData();
+    for (size_t i = 0; i < frameSize; i++){
+        data[i] = (i * 31) & 255;
+    }
+    ofPixels out;
+    out.allocate(width, height, channels);
+
+    ofxPixelBuffer buffer(width, height, channels, frames);
+    for (int i = 0; i < frames; i++){
+        buffer.write(i, source);
+    }
+    ofxPixelBuffer chunk(source, 1);
+
+    int counter = 0;
+
+    // buffer
+    measure("buffer.write", frameSize, [&](){
+        buffer.write(counter++ % frames, source);
+    });
+    measure("buffer.read", 0, [&](){
+        mySink += buffer.read(counter++ % frames).getData()[0];
+    });
+    measure("buffer.readLinear", frameSize, [&](){
+        buffer.readLinearInto(counter++ % (frames - 1) + 0.5f, out);
+    });
+    measure("buffer.readCubic", frameSize, [&](){
+        buffer.readCubicInto(counter++ % (frames - 1) + 0.5f, out);
+    });
+    // a 256 x 256 crop: should cost a fraction of the full frame
+    ofRectangle region(width / 4, height / 4, min(256, width / 2), min(256, height / 2));
+    size_t regionSize = (size_t)region.width * region.height * channels;
+    ofPixels regionOut;
+    measure("buffer.readRegion", regionSize, [&](){
+        buffer.readRegion(counter++ % frames, region, regionOut);
+    });
+    measure("buffer.readLinearRegion", regionSize, [&](){
+        buffer.readLinearRegion(counter++ % (frames - 1) + 0.5f, region, regionOut);
+    });
+    measure("buffer.pushBack", frameSize, [&](){
+        buffer.pushBack(source);
+    }, [&](){
+        if (buffer.size() >= frames * 2){
+            buffer.resize(frames);
+        }
+    });
+    buffer.resize(frames);
+    measure("buffer.pushFront", frameSize, [&](){
+        buffer.pushFront(source);
+    }, [&](){
+        if (buffer.size() >= frames * 2){
+            buffer.resize(frames);
+        }
+    });
+    buffer.resize(frames);
+    measure("buffer.popFront", frameSize, [&](){
+        mySink += buffer.popFront().getData()[0];
+    }, [&](){
+        if (buffer.size() <= 1){
+            buffer.resize(frames);
+        }
+    });
+    buffer.resize(frames);
+    // FIFO: pop a batch and push it back. in frame storage the frames are only moved
+    vector<ofPixels> batch;
+    measure("buffer.fifo", 0, [&](){
+        batch.clear();
+        buffer.popFront(frames / 2, batch);
+        buffer.pushBack(move(batch));
+    });
+    // sliding window: the removed frame is recycled by the next push
+    measure("buffer.slide", frameSize, [&](){
+        buffer.pushBack(source);
+        buffer.remove(0, 1);
+    });
+    measure("buffer.insert", frameSize, [&](){
+        buffer.insert(chunk, buffer.size() / 2);
+    }, [&](){
+        if (buffer.size() >= frames * 2){
+            buffer.resize(frames);
+        }
+    });
+    buffer.resize(frames);
+    measure("buffer.remove", 0, [&](){
+        buffer.remove(buffer.size() / 2, 1);
+    }, [&](){
+        if (buffer.size() <= 1){
+            buffer.resize(frames);
+        }
+    });
+    buffer.resize(frames);
+    // shrink to half and grow back, each step moves half the buffer
+    measure("buffer.resize", frameSize * (frames / 2), [&](){
+        buffer.resize(buffer.size() == frames ? frames / 2 : frames);
+    });
+    buffer.resize(frames);
+    // copies share the frames until one of them writes to a frame
+    measure("buffer.copy", 0, [&](){
+        ofxPixelBuffer copy(buffer);
+        mySink += copy.size();
+    });
+    measure("buffer.copy.write", frameSize, [&](){
+        ofxPixelBuffer copy(buffer);
+        copy.write(0, source);
+    });
+    measure("buffer.clearPixels", frameSize * frames, [&](){
+        buffer.clearPixels();
+    });
+    for (int i = 0; i < frames; i++){
+        buffer.write(i, source);
+    }
+
+    // lerp kernels: the generic float loop readLinear used to run and the kernels picked by name.
+    // the frames are blended as flat arrays, so the channel count only changes the frame size.
+    {
+        ofPixels frame2 = source;
+        const unsigned char* src1 = source.getData();
+        const unsigned char* src2 = frame2.getData();
+        unsigned char* dst = out.getData();
+        // the weight is only known at run time, like in readLinear
+        volatile float weight = 0.5f;
+        measure("kernel.lerp.generic", frameSize, [&](){
+            lerpGeneric(src1, src2, dst, frameSize, weight);
+        });
+        for (string name : {"scalar", "sse2", "avx2"}){
+            ofxPixelBufferLerpKernel kernel = ofxPixelBufferGetLerpKernel(name.c_str());
+            if (kernel){
+                measure("kernel.lerp." + name, frameSize, [&](){
+                    kernel(src1, src2, dst, frameSize, 128);
+                });
+            }
+        }
+    }
+
+    // interpolation of 16-bit and float frames (bytes per op = bytes of the output frame)
+    {
+        ofxShortPixelBuffer shortBuffer(width, height, channels, 2);
+        ofShortPixels shortOut;
+        measure("buffer16.readLinear", frameSize * sizeof(unsigned short), [&](){
+            shortBuffer.readLinearInto(0.5f, shortOut);
+        });
+    }
+    {
+        ofxFloatPixelBuffer floatBuffer(width, height, channels, 2);
+        ofFloatPixels floatOut;
+        measure("bufferFloat.readLinear", frameSize * sizeof(float), [&](){
+            floatBuffer.readLinearInto(0.5f, floatOut);
+        });
+    }
+
+    // ring buffer
+    ofxPixelRingBuffer ringBuffer(width, height, channels, frames);
+    measure("ringbuffer.in", frameSize, [&](){
+        ringBuffer.in(source);
+    });
+    measure("ringbuffer.readLinearRegion", regionSize, [&](){
+        ringBuffer.readLinearRegion(counter++ % (frames - 1) + 0.5f, region, regionOut);
+    });
+
+    // recorder
+    ofxPixelBufferRecorder recorder(buffer);
+    recorder.record();
+    measure("recorder.in", frameSize, [&](){
+        recorder.in(source);
+    }, [&](){
+        if (recorder.getRecordedFrames() >= buffer.size()){
+            recorder.record();
+        }
+    });
+
+    // player, without and with interpolation
+    ofxPixelBufferPlayer player(buffer);
+    player.setLoopState(true);
+    player.setFrameRate(30);
+    for (auto mode : {OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST, OFX_PIXEL_BUFFER_INTERPOLATION_LINEAR, OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC}){
+        player.setInterpolation(mode);
+        player.play();
+        string name = mode == OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC ? "player.update.cubic"
+                    : mode == OFX_PIXEL_BUFFER_INTERPOLATION_LINEAR ? "player.update.lerp" : "player.update";
+        // without interpolation the player only hands out a reference
+        measure(name, mode != OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST ? frameSize : 0, [&](){
+            player.update();
+            mySink += player.getPixels().getData()[0];
+        });
+        player.stop();
+    }
+    // interpolating player standing still (speed 0): the last blend is kept
+    player.setInterpolation(OFX_PIXEL_BUFFER_INTERPOLATION_LINEAR);
+    player.setSpeed(0);
+    player.play(1.5f);
+    measure("player.update.still", 0, [&](){
+        player.update();
+        mySink += player.getPixels().getData()[0];
+    });
+    player.stop();
+    player.setSpeed(1);
+
+    // 16 interpolating players on 4 positions, updated one by one and as a group
+    vector<ofxPixelBufferPlayer> players(16, ofxPixelBufferPlayer(buffer));
+    ofxPixelBufferPlayerGroup group;
+    for (int i = 0; i < (int)players.size(); ++i){
+        players[i].setLoopState(true);
+        players[i].setInterpolation(OFX_PIXEL_BUFFER_INTERPOLATION_LINEAR);
+        players[i].play((i % 4) + 0.5f);
+        group.add(players[i]);
+    }
+    measure("player.update.many", frameSize * players.size(), [&](){
+        for (auto& p : players){
+            p.update();
+            mySink += p.getPixels().getData()[0];
+        }
+    });
+    measure("player.group", frameSize * players.size(), [&](){
+        group.update();
+        for (auto& p : players){
+            mySink += p.getPixels().getData()[0];
+        }
+    });
+    group.clear();
+
+    // compressed storage. the frames are read in order, so every read is a cache miss
+    ofxPixelBuffer compressed(buffer);
+    compressed.setStorage(OFX_PIXEL_BUFFER_STORAGE_COMPRESSED);
+    measure("compressed.write", frameSize, [&](){
+        compressed.write(counter++ % frames, source);
+    });
+    measure("compressed.read", frameSize, [&](){
+        mySink += compressed.read(counter++ % frames).getData()[0];
+    });
+    measure("compressed.readLinear", frameSize, [&](){
+        compressed.readLinearInto(counter++ % (frames - 1) + 0.5f, out);
+    });
+
+    // delta encoded recording of a static input: only the tiles are compared
+    ofxPixelBuffer deltaBuffer(buffer);
+    ofxPixelBufferRecorder deltaRecorder(deltaBuffer);
+    deltaRecorder.setDeltaEncoding(true);
+    deltaRecorder.record();
+    measure("recorder.in.delta", frameSize, [&](){
+        deltaRecorder.in(source);
+    }, [&](){
+        if (deltaRecorder.getRecordedFrames() >= deltaBuffer.size()){
+            deltaRecorder.record();
+        }
+    });
+    measure("delta.read", frameSize, [&](){
+        mySink += deltaBuffer.read(counter++ % frames).getData()[0];
+    });
+
+    // recording to disk: only the hand-off to the writer thread is timed, frames are dropped if the disk can't keep up
+    if (isEnabled("recorder.in.file")){
+        ofxPixelBufferRecorder fileRecorder;
+        string path = ofToDataPath("benchmark-recording.raw");
+        if (fileRecorder.recordToFile(path, width, height, channels)){
+            measure("recorder.in.file", frameSize, [&](){
+                fileRecorder.in(source);
+            });
+            ofxPixelBufferWriterStats stats = fileRecorder.getFileStats();
+            cerr << "  recorder.in.file: " << stats.framesWritten << " frames written, " << stats.framesDropped << " dropped, "
+                 << stats.throughput / (1024 * 1024) << " MB/s\n";
+            fileRecorder.closeFile();
+            remove(path.c_str());
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::measure(const string& name, size_t bytesPerOp, function<void()> op, function<void()> prepare){
+    if (!isEnabled(name)){
+        return;
+    }
+    using clock = chrono::steady_clock;
+
+    BenchmarkResult result = myCurrent;
+    result.name = name;
+    result.bytesPerOp = bytesPerOp;
+    result.samples.reserve(myMaxIterations);
+
+    // warm up caches and lazily allocated frames
+    if (prepare){
+        prepare();
+    }
+    op();
+
+    double total = 0;
+    while ((total < myMinTime || result.samples.size() < 5) && (int)result.samples.size() < myMaxIterations){
+        if (prepare){
+            prepare();
+        }
+        auto t0 = clock::now();
+        op();
+        auto t1 = clock::now();
+        double ns = chrono::duration<double, nano>(t1 - t0).count();
+        result.samples.push_back(ns);
+        total += ns * 1e-9;
+    }
+
+    cerr << name << " " << result.resolution << " x" << result.channels << ": "
+         << result.samples.size() << " iterations\n";
+    myResults.push_back(move(result));
+}
+
+//--------------------------------------------------------------
+string ofApp::toJson() const {
+    ostringstream json;
+    json << "{\n";
+    json << "  \"benchmark\": \"ofxPixelBuffer\",\n";
+    json << "  \"timestamp\": \"" << ofGetTimestampString("%Y-%m-%dT%H:%M:%S") << "\",\n";
+    json << "  \"minTime\": " << myMinTime << ",\n";
+    json << "  \"maxIterations\": " << myMaxIterations << ",\n";
+    json << "  \"results\": [";
+    json << fixed << setprecision(1);
+    for (size_t i = 0; i < myResults.size(); i++){
+        auto& r = myResults[i];
+        vector<double> sorted = r.samples;
+        sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+        double sum = 0;
+        for (double s : sorted){
+            sum += s;
+        }
+        double mean = sum / n;
+        double median = (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+        double p99 = sorted[min(n - 1, (size_t)(n * 0.99))];
+
+        json << (i ? ",\n" : "\n");
+        json << "    {\"name\": \"" << r.name << "\""
+             << ", \"resolution\": \"" << r.resolution << "\""
+             << ", \"width\": " << r.width
+             << ", \"height\": " << r.height
+             << ", \"channels\": " << r.channels
+             << ", \"frames\": " << r.frames
+             << ", \"iterations\": " << n
+             << ", \"meanNs\": " << mean
+             << ", \"medianNs\": " << median
+             << ", \"p99Ns\": " << p99
+             << ", \"minNs\": " << sorted.front()
+             << ", \"maxNs\": " << sorted.back()
+             << ", \"opsPerSecond\": " << 1e9 / mean;
+        if (r.bytesPerOp > 0){
+            // throughput based on the median so outliers don't skew it
+            json << ", \"megabytesPerSecond\": " << r.bytesPerOp / median * 1e9 / (1 << 20);
+        }
+        json << "}";
+    }
+    json << "\n  ]\n}\n";
+    return json.str();
+}
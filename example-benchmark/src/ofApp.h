@@ -0,0 +1,38 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxPixelBuffer.h"
+#include "ofxPixelBufferPlayerGroup.h"
+
+// timing results of a single benchmark case
+struct BenchmarkResult {
+    string name;
+    string resolution;
+    int width;
+    int height;
+    int channels;
+    int frames; // buffer size
+    size_t bytesPerOp; // 0 = not a data moving operation
+    vector<double> samples; // nanoseconds per operation
+};
+
+class ofApp : public ofBaseApp {
+    public:
+        void setup();
+
+        bool bQuick = false;
+        string myOutputPath;
+        vector<string> myFilter;
+    protected:
+        bool isEnabled(const string& name) const;
+        void runResolution(const string& label, int width, int height, int channels);
+        // calls 'op' repeatedly, 'prepare' runs untimed before every call
+        void measure(const string& name, size_t bytesPerOp, function<void()> op, function<void()> prepare = nullptr);
+        string toJson() const;
+
+        vector<BenchmarkResult> myResults;
+        BenchmarkResult myCurrent;
+        double myMinTime; // seconds per case
+        int myMaxIterations;
+        volatile unsigned int mySink = 0; // keeps results of pure reads alive
+};
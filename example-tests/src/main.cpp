@@ -0,0 +1,24 @@
+#include "tests.h"
+
+// runs without a window. the exit code is the number of failed tests.
+// usage: example-tests
+int main(){
+    struct Test {
+        string name;
+        function<bool()> run;
+    };
+    vector<Test> tests = {
+        {"kernels.lerp", testLerpKernels},
+        {"ringbuffer.concurrent", testRingBufferConcurrent}
+    };
+
+    int failed = 0;
+    for (auto& test : tests){
+        bool success = test.run();
+        cerr << test.name << ": " << (success ? "ok" : "failed!") << "\n";
+        if (!success){
+            failed++;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,68 @@
+#include "tests.h"
+#include "ofxPixelBufferKernels.h"
+
+#include <random>
+
+// the float blend readLinear used before the fixed-point kernels
+static float blendFloat(unsigned char a, unsigned char b, float weight){
+    return a * (1.f - weight) + b * weight;
+}
+
+// every available 8-bit lerp kernel against the float blend, for all weights (0 - 256)
+// and sizes which aren't a multiple of the vector width. also checks the kernel picked by
+// ofxPixelBufferLerp with float weights. the results may differ by 1 because of the rounding.
+bool testLerpKernels(){
+    mt19937 random(1234);
+    uniform_int_distribution<int> byte(0, 255);
+    const size_t maxSize = 1000;
+    vector<unsigned char> src1(maxSize + 1), src2(maxSize + 1), dst(maxSize + 1);
+    for (size_t i = 0; i <= maxSize; i++){
+        src1[i] = byte(random);
+        src2[i] = byte(random);
+    }
+    // the extremes, where rounding errors would show first
+    src1[0] = 0;
+    src2[0] = 255;
+    src1[1] = 255;
+    src2[1] = 0;
+
+    int failed = 0;
+    // check 'size' values starting at 'offset' (unaligned data)
+    auto check = [&](const string& name, size_t offset, size_t size, float weight){
+        for (size_t i = 0; i < size; i++){
+            float expected = blendFloat(src1[offset + i], src2[offset + i], weight);
+            if (fabsf(dst[offset + i] - expected) > 1.f){
+                if (failed++ < 10){
+                    cerr << name << ": size " << size << ", weight " << weight << ", index " << i << ": "
+                         << (int)dst[offset + i] << " instead of " << expected << "!\n";
+                }
+                return;
+            }
+        }
+    };
+
+    vector<size_t> sizes = {1, 3, 15, 16, 17, 31, 33, 63, 65, 999, maxSize};
+    for (auto name : {"scalar", "sse2", "avx2"}){
+        ofxPixelBufferLerpKernel kernel = ofxPixelBufferGetLerpKernel(name);
+        if (!kernel){
+            cerr << "lerp kernel " << name << " not available, skipped\n";
+            continue;
+        }
+        for (size_t size : sizes){
+            size_t offset = (size % 2) ? 1 : 0;
+            size = min(size, maxSize + 1 - offset);
+            for (int weight = 0; weight <= 256; weight++){
+                kernel(&src1[offset], &src2[offset], &dst[offset], size, weight);
+                check(name, offset, size, weight / 256.f);
+            }
+        }
+    }
+    for (size_t size : sizes){
+        for (int i = 0; i <= 100; i++){
+            float weight = i / 100.f;
+            ofxPixelBufferLerp(src1.data(), src2.data(), dst.data(), size, weight);
+            check(ofxPixelBufferGetKernels<unsigned char>().name, 0, size, weight);
+        }
+    }
+    return failed == 0;
+}
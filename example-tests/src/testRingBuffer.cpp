@@ -0,0 +1,90 @@
+#include "tests.h"
+
+#include <thread>
+
+// true if all pixels have the same value
+static bool isUniform(const ofPixels& pixels){
+    const unsigned char* data = pixels.getData();
+    for (size_t i = 1; i < pixels.size(); i++){
+        if (data[i] != data[0]){
+            return false;
+        }
+    }
+    return true;
+}
+
+// one thread pushes frames through in(), in(&&) and acquireWriteSlot() / commit() while another
+// thread reads them with readInto(), readLinearInto() and readCubicInto(). every frame is filled with
+// a single value, so the blends of whole frames are uniform as well: anything else is a torn frame.
+// run under ThreadSanitizer (see config.make) to catch data races.
+bool testRingBufferConcurrent(){
+    const int width = 64;
+    const int height = 32;
+    const int channels = 3;
+    const int numFrames = 50000;
+
+    ofxPixelRingBuffer ringBuffer;
+    ringBuffer.setConcurrent(true);
+    ringBuffer.allocate(width, height, channels, 4);
+    ofPixels blank;
+    blank.allocate(width, height, channels);
+    blank.set(0);
+    for (int i = 0; i < 5; i++){
+        ringBuffer.in(blank);
+    }
+
+    atomic<bool> bDone(false);
+    thread producer([&](){
+        ofPixels frame;
+        frame.allocate(width, height, channels);
+        for (int i = 1; i < numFrames; i++){
+            switch (i % 3){
+                case 0:
+                    frame.set(i & 255);
+                    ringBuffer.in(frame);
+                    break;
+                case 1: {
+                    ofPixels copy;
+                    copy.allocate(width, height, channels);
+                    copy.set(i & 255);
+                    ringBuffer.in(move(copy));
+                    break;
+                }
+                default:
+                    if (ofPixels* slot = ringBuffer.acquireWriteSlot()){
+                        slot->set(i & 255);
+                        ringBuffer.commit();
+                    }
+                    break;
+            }
+        }
+        bDone = true;
+    });
+
+    int torn = 0;
+    int reads = 0;
+    ofPixels out;
+    while (!bDone){
+        for (int i = 0; i < ringBuffer.size(); i++){
+            if (ringBuffer.readInto(i, out) && !isUniform(out)){
+                torn++;
+            }
+        }
+        ringBuffer.readLinearInto(1.f, out);
+        torn += !isUniform(out);
+        ringBuffer.readLinearInto(ringBuffer.size() - 1.f, out);
+        torn += !isUniform(out);
+        ringBuffer.readCubicInto(1.5f, out);
+        torn += !isUniform(out);
+        reads++;
+    }
+    producer.join();
+
+    cerr << "ringbuffer.concurrent: " << reads << " read passes, "
+         << ringBuffer.getNumDroppedFrames() << " dropped frames\n";
+    if (torn > 0){
+        cerr << torn << " torn frames!\n";
+        return false;
+    }
+    return true;
+}
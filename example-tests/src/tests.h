@@ -0,0 +1,8 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxPixelBuffer.h"
+
+// every test prints what went wrong to stderr and returns false if it failed
+bool testLerpKernels();
+bool testRingBufferConcurrent();
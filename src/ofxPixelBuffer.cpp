@@ -1,11 +1,100 @@
 #include "ofxPixelBuffer.h"
+#include "ofxPixelBufferKernels.h"
+#include "ofxPixelBufferFile.h"
+#include "ofxPixelBufferStream.h"
 
 
 /// ofxPixelBuffer classes
 
 /// ofxPixelBuffer
 
-ofxPixelBuffer::ofxPixelBuffer(){
+// alignment of the frames in slab storage (cache line size, also good for SIMD)
+static const size_t slabAlignment = 64;
+
+static unsigned char* alignedAlloc(size_t bytes){
+#ifdef TARGET_WIN32
+    return static_cast<unsigned char*>(_aligned_malloc(bytes, slabAlignment));
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, slabAlignment, bytes) != 0){
+        return nullptr;
+    }
+    return static_cast<unsigned char*>(ptr);
+#endif
+}
+
+static void alignedFree(unsigned char* ptr){
+#ifdef TARGET_WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+// copy 8-bit pixels (e.g. from a movie loader) into a frame, converting to the range
+// of the pixel type like ofPixels_ does: 0 - 65535 for 16-bit and 0 - 1 for float.
+static void copyPixels(const unsigned char* src, unsigned char* dst, size_t size){
+    memcpy(dst, src, size);
+}
+
+static void copyPixels(const unsigned char* src, unsigned short* dst, size_t size){
+    for (size_t i = 0; i < size; ++i){
+        dst[i] = src[i] * 257;
+    }
+}
+
+static void copyPixels(const unsigned char* src, float* dst, size_t size){
+    for (size_t i = 0; i < size; ++i){
+        dst[i] = src[i] / 255.f;
+    }
+}
+
+// clip 'rect' to a frame of width x height, rounding the edges to whole pixels.
+// false if nothing is left.
+static bool clipRegion(const ofRectangle& rect, int width, int height, int& x, int& y, int& w, int& h){
+    int x0 = max(0.f, roundf(min(rect.x, rect.x + rect.width)));
+    int y0 = max(0.f, roundf(min(rect.y, rect.y + rect.height)));
+    int x1 = min<float>(width, roundf(max(rect.x, rect.x + rect.width)));
+    int y1 = min<float>(height, roundf(max(rect.y, rect.y + rect.height)));
+    if (x1 <= x0 || y1 <= y0){
+        return false;
+    }
+    x = x0;
+    y = y0;
+    w = x1 - x0;
+    h = y1 - y0;
+    return true;
+}
+
+// call func(srcOffset, dstOffset, size) for the rows of a region, in values (not bytes).
+// the rows are 'width' pixels apart in the frame and packed in the destination.
+// a region spanning the whole width is a single block.
+template<typename F>
+static void forEachRow(int width, int channels, int x, int y, int w, int h, F func){
+    size_t rowSize = (size_t)w * channels;
+    size_t stride = (size_t)width * channels;
+    size_t offset = (size_t)y * stride + (size_t)x * channels;
+    if (w == width){
+        func(offset, 0, rowSize * h);
+        return;
+    }
+    for (int row = 0; row < h; ++row){
+        func(offset + row * stride, row * rowSize, rowSize);
+    }
+}
+
+// wait for a movie loader thread. the completion callback runs on the loader thread and may start
+// the next load or destroy the buffer: then the loader is done with the buffer and only has to return.
+static void joinLoader(thread& loader){
+    if (loader.get_id() == this_thread::get_id()){
+        loader.detach();
+    } else if (loader.joinable()){
+        loader.join();
+    }
+}
+
+template<typename T>
+ofxPixelBuffer_<T>::ofxPixelBuffer_(){
     myWidth = 0;
     myHeight = 0;
     myChannels = 0;
@@ -14,48 +103,59 @@ ofxPixelBuffer::ofxPixelBuffer(){
     bAllocated = false;
     myLoader = nullptr;
     bThreaded = false;
+    myKernels = &ofxPixelBufferGetKernels<T>();
+    myStorage = OFX_PIXEL_BUFFER_STORAGE_FRAMES;
+    mySlab = nullptr;
+    mySlabStride = 0;
+    mySlabFrames = 0;
+    myKeyframeInterval = 30;
+    myTileSize = 32;
+    myPool = make_shared<ofxPixelBufferFramePool_<T>>();
+    bLoading = false;
+    bCancelLoad = false;
+    myLoadedFrames = 0;
+    myFramesToLoad = 0;
+    myLoadOnset = 0;
+    myVersion = 0;
 }
 
-ofxPixelBuffer::ofxPixelBuffer(int width, int height, int channels, int frames)
-    : ofxPixelBuffer() {
+template<typename T>
+ofxPixelBuffer_<T>::ofxPixelBuffer_(int width, int height, int channels, int frames)
+    : ofxPixelBuffer_<T>() {
     allocate(width, height, channels, frames);
 }
 
-ofxPixelBuffer::ofxPixelBuffer(const ofPixels& pix, int frames)
-    : ofxPixelBuffer() {
+template<typename T>
+ofxPixelBuffer_<T>::ofxPixelBuffer_(const ofPixels_<T>& pix, int frames)
+    : ofxPixelBuffer_<T>() {
     allocate(pix, frames);
 }
 
-ofxPixelBuffer::ofxPixelBuffer(const ofxPixelBuffer& mom){
-    if (&mom == this){
-        return;
+template<typename T>
+ofxPixelBuffer_<T>::~ofxPixelBuffer_(){
+    cancelLoad();
+    // the frames are only views into the slab
+    clearFrames();
+    freeStorage();
+}
+
+template<typename T>
+ofxPixelBuffer_<T>::ofxPixelBuffer_(const ofxPixelBuffer_<T>& mom)
+    : ofxPixelBuffer_<T>() {
+    if (mom.bAllocated){
+        copyFrom(mom);
     } else {
-        if (mom.bAllocated){
-            myWidth = mom.myWidth;
-            myHeight = mom.myHeight;
-            myChannels = mom.myChannels;
-            mySize = mom.mySize;
-            myFrameSize = mom.myFrameSize;
-            myBuffer = mom.myBuffer;
-            bAllocated = true;
-        } else {
         cout << "couldn't copy: mom not allocated!\n";
-        }
     }
 }
 
-ofxPixelBuffer& ofxPixelBuffer::operator= (const ofxPixelBuffer& mom){
+template<typename T>
+ofxPixelBuffer_<T>& ofxPixelBuffer_<T>::operator= (const ofxPixelBuffer_<T>& mom){
     if (&mom == this){
         return *this;
     } else {
         if (mom.bAllocated){
-            myWidth = mom.myWidth;
-            myHeight = mom.myHeight;
-            myChannels = mom.myChannels;
-            mySize = mom.mySize;
-            myFrameSize = mom.myFrameSize;
-            myBuffer = mom.myBuffer;
-            bAllocated = true;
+            copyFrom(mom);
         } else {
             cout << "couldn't copy: mom not allocated!\n";
         }
@@ -63,36 +163,300 @@ ofxPixelBuffer& ofxPixelBuffer::operator= (const ofxPixelBuffer& mom){
     }
 }
 
-ofxPixelBuffer::ofxPixelBuffer(ofxPixelBuffer&& mom){
+template<typename T>
+ofxPixelBuffer_<T>::ofxPixelBuffer_(ofxPixelBuffer_<T>&& mom)
+    : ofxPixelBuffer_<T>() {
     if (mom.bAllocated){
-        myWidth = mom.myWidth;
-        myHeight = mom.myHeight;
-        myChannels = mom.myChannels;
-        mySize = mom.mySize;
-        myFrameSize = mom.myFrameSize;
-        myBuffer = move(mom.myBuffer);
-        bAllocated = true;
+        moveFrom(mom);
     } else {
         cout << "couldn't move: mom not allocated!\n";
     }
 }
 
-ofxPixelBuffer& ofxPixelBuffer::operator= (ofxPixelBuffer&& mom){
+template<typename T>
+ofxPixelBuffer_<T>& ofxPixelBuffer_<T>::operator= (ofxPixelBuffer_<T>&& mom){
+    if (&mom == this){
+        return *this;
+    }
     if (mom.bAllocated){
-        myWidth = mom.myWidth;
-        myHeight = mom.myHeight;
-        myChannels = mom.myChannels;
-        mySize = mom.mySize;
-        myFrameSize = mom.myFrameSize;
-        myBuffer = move(mom.myBuffer);
-        bAllocated = true;
+        moveFrom(mom);
     } else {
         cout << "couldn't move: mom not allocated!\n";
     }
     return *this;
 }
 
-void ofxPixelBuffer::allocate(int width, int height, int channels, int frames){
+template<typename T>
+void ofxPixelBuffer_<T>::copyFrom(const ofxPixelBuffer_<T>& mom){
+    myVersion++;
+    cancelLoad();
+    clearFrames();
+    freeStorage();
+    myWidth = mom.myWidth;
+    myHeight = mom.myHeight;
+    myChannels = mom.myChannels;
+    myFrameSize = mom.myFrameSize;
+    myKeyframeInterval = mom.myKeyframeInterval;
+    myTileSize = mom.myTileSize;
+    if (mom.myStorage == OFX_PIXEL_BUFFER_STORAGE_STREAMED){
+        // stream the same file
+        loadStreamed(mom.myStream->getPath(), mom.myStream->getCacheSize());
+        return;
+    }
+    if (mom.myStorage == OFX_PIXEL_BUFFER_STORAGE_COMPRESSED){
+        myCompressed.reset(new ofxPixelBufferCompressedFrames_<T>(*mom.myCompressed));
+        myStorage = OFX_PIXEL_BUFFER_STORAGE_COMPRESSED;
+        mySize = mom.mySize;
+        bAllocated = true;
+        return;
+    }
+    if (mom.myStorage == OFX_PIXEL_BUFFER_STORAGE_DELTA){
+        // shares the (immutable) tiles
+        myDelta.reset(new ofxPixelBufferDeltaFrames_<T>(*mom.myDelta));
+        myStorage = OFX_PIXEL_BUFFER_STORAGE_DELTA;
+        mySize = mom.mySize;
+        bAllocated = true;
+        return;
+    }
+    // copies of mapped frames get their own memory
+    myStorage = (mom.myStorage == OFX_PIXEL_BUFFER_STORAGE_MAPPED) ? OFX_PIXEL_BUFFER_STORAGE_FRAMES : mom.myStorage;
+    bAllocated = true;
+    // slab storage copies into a slab of our own, otherwise the frames are shared
+    reserve(mom.mySize);
+    for (int i = 0; i < mom.mySize; ++i){
+        myBuffer.push_back(shareFrame(mom, i));
+    }
+    mySize = myBuffer.size();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::moveFrom(ofxPixelBuffer_<T>& mom){
+    myVersion++;
+    cancelLoad();
+    // the loader thread of mom writes into the frames we are about to take over.
+    // the frames loaded so far are kept, the future and the callback get false.
+    mom.cancelLoad();
+    clearFrames();
+    freeStorage();
+    myWidth = mom.myWidth;
+    myHeight = mom.myHeight;
+    myChannels = mom.myChannels;
+    myFrameSize = mom.myFrameSize;
+    myKeyframeInterval = mom.myKeyframeInterval;
+    myTileSize = mom.myTileSize;
+    myStorage = mom.myStorage;
+    mySize = mom.mySize;
+    myBuffer = move(mom.myBuffer);
+    myBlocks = move(mom.myBlocks);
+    // take over the slab (if any)
+    mySlab = mom.mySlab;
+    mySlabStride = mom.mySlabStride;
+    mySlabFrames = mom.mySlabFrames;
+    myFreeSlots = move(mom.myFreeSlots);
+    myMapping = move(mom.myMapping);
+    myStream = move(mom.myStream);
+    myCompressed = move(mom.myCompressed);
+    myDelta = move(mom.myDelta);
+    mom.mySlab = nullptr;
+    mom.mySlabFrames = 0;
+    // mom has no storage left, so it starts over with plain frames (freeStorage() can't tell anymore)
+    mom.myStorage = OFX_PIXEL_BUFFER_STORAGE_FRAMES;
+    mom.clearBuffer();
+    bAllocated = true;
+}
+
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::newFrame(){
+    ofPixels_<T> frame;
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+        if (myFreeSlots.empty()){
+            // grow geometrically, so pushing frames one by one doesn't reallocate every time
+            growSlab(max(1, mySlabFrames / 2));
+        }
+        int slot = myFreeSlots.back();
+        myFreeSlots.pop_back();
+        frame.setFromExternalPixels(reinterpret_cast<T*>(mySlab + slot * mySlabStride), myWidth, myHeight, myChannels);
+    } else {
+        frame = adoptFrame(acquireFrame());
+    }
+    return frame;
+}
+
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::acquireFrame(){
+    bool allocated;
+    ofPixels_<T> frame = myPool->acquire(myWidth, myHeight, myChannels, &allocated);
+    if (allocated){
+        OFX_PIXEL_BUFFER_COUNT_ALLOCATIONS(myCounters, 1);
+    }
+    return frame;
+}
+
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::adoptFrame(ofPixels_<T>&& pixels){
+    return viewBlock(make_shared<ofPixels_<T>>(move(pixels)));
+}
+
+// a new view into a block, counted by this buffer
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::viewBlock(const shared_ptr<ofPixels_<T>>& pixels){
+    Block& block = myBlocks[pixels->getData()];
+    block.pixels = pixels;
+    block.frames++;
+    ofPixels_<T> view;
+    view.setFromExternalPixels(pixels->getData(), myWidth, myHeight, myChannels);
+    return view;
+}
+
+// drop a view. the last owner recycles the memory
+template<typename T>
+void ofxPixelBuffer_<T>::releaseBlock(typename unordered_map<const T*, Block>::iterator it){
+    if (--it->second.frames == 0){
+        if (it->second.pixels.use_count() == 1){
+            myPool->release(move(*it->second.pixels));
+        }
+        myBlocks.erase(it);
+    }
+}
+
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::shareFrame(const ofxPixelBuffer_<T>& buffer, int index){
+    // the loader thread of 'buffer' still writes into the frames it hasn't loaded yet,
+    // so neither share nor copy them before they are done. (loaded frames aren't touched again)
+    while (buffer.isFrameLoading(index)){
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    if (myStorage != OFX_PIXEL_BUFFER_STORAGE_SLAB && index < (int)buffer.myBuffer.size()){
+        auto it = buffer.myBlocks.find(buffer.myBuffer[index].getData());
+        if (it != buffer.myBlocks.end()){
+            return viewBlock(it->second.pixels);
+        }
+    }
+    // slab slots, mapped, streamed and compressed frames are copied
+    ofPixels_<T> frame = newFrame();
+    memcpy(frame.getData(), buffer.getFrame(index).getData(), myFrameSize);
+    OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+    return frame;
+}
+
+template<typename T>
+ofPixels_<T>& ofxPixelBuffer_<T>::unshareFrame(int index, bool keepPixels){
+    ofPixels_<T>& frame = myBuffer[index];
+    auto it = myBlocks.find(frame.getData());
+    if (it != myBlocks.end() && isShared(it->second)){
+        // somebody else keeps the block alive
+        releaseBlock(it);
+        ofPixels_<T> copy = adoptFrame(acquireFrame());
+        if (keepPixels){
+            memcpy(copy.getData(), frame.getData(), myFrameSize);
+            OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+        }
+        frame = move(copy);
+    }
+    return frame;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::clearFrames(){
+    myBuffer.clear();
+    myBlocks.clear();
+}
+
+template<typename T>
+int ofxPixelBuffer_<T>::getNumSharedFrames() const {
+    int count = 0;
+    for (auto& block : myBlocks){
+        if (isShared(block.second)){
+            count += block.second.frames;
+        }
+    }
+    return count;
+}
+
+template<typename T>
+bool ofxPixelBuffer_<T>::isSameFrame(int index1, int index2) const {
+    if (index1 == index2){
+        return true;
+    }
+    // only frame storage shares memory between frames
+    if (myStorage != OFX_PIXEL_BUFFER_STORAGE_FRAMES || index1 < 0 || index2 < 0
+            || index1 >= (int)myBuffer.size() || index2 >= (int)myBuffer.size()){
+        return false;
+    }
+    return myBuffer[index1].getData() == myBuffer[index2].getData();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::releaseFrame(ofPixels_<T>& frame){
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(frame.getData());
+    auto it = myBlocks.find(frame.getData());
+    if (it != myBlocks.end()){
+        releaseBlock(it);
+    } else if (mySlab && data >= mySlab && data < mySlab + mySlabFrames * mySlabStride){
+        myFreeSlots.push_back((data - mySlab) / mySlabStride);
+    }
+    frame.clear();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::growSlab(int frames){
+    if (frames <= 0){
+        return;
+    }
+    if (!mySlab){
+        mySlabStride = (myFrameSize + slabAlignment - 1) / slabAlignment * slabAlignment;
+    }
+    int newCapacity = mySlabFrames + frames;
+    unsigned char* newSlab = alignedAlloc(newCapacity * mySlabStride);
+    if (!newSlab){
+        throw bad_alloc();
+    }
+    OFX_PIXEL_BUFFER_COUNT_ALLOCATIONS(myCounters, frames);
+    if (mySlab){
+        memcpy(newSlab, mySlab, mySlabFrames * mySlabStride);
+        OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, mySlabFrames * mySlabStride);
+        // repoint the frames to the new slab
+        for (auto& frame : myBuffer){
+            unsigned char* data = reinterpret_cast<unsigned char*>(frame.getData());
+            if (data >= mySlab && data < mySlab + mySlabFrames * mySlabStride){
+                frame.setFromExternalPixels(reinterpret_cast<T*>(newSlab + (data - mySlab)), myWidth, myHeight, myChannels);
+            }
+        }
+        alignedFree(mySlab);
+    }
+    // the new slots are handed out in ascending order (after the old free slots),
+    // so a fresh slab is touched sequentially.
+    vector<int> newSlots;
+    for (int i = newCapacity - 1; i >= mySlabFrames; --i){
+        newSlots.push_back(i);
+    }
+    myFreeSlots.insert(myFreeSlots.begin(), newSlots.begin(), newSlots.end());
+    mySlab = newSlab;
+    mySlabFrames = newCapacity;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::freeStorage(){
+    if (mySlab){
+        alignedFree(mySlab);
+        mySlab = nullptr;
+    }
+    mySlabStride = 0;
+    mySlabFrames = 0;
+    myFreeSlots.clear();
+    if (myMapping || myStream || myCompressed || myDelta){
+        myMapping.reset();
+        myStream.reset();
+        myCompressed.reset();
+        myDelta.reset();
+        // new frames get their own memory
+        myStorage = OFX_PIXEL_BUFFER_STORAGE_FRAMES;
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::allocate(int width, int height, int channels, int frames){
+    myVersion++;
     width = std::max(0, width);
     height = std::max(0, height);
     if (channels < 1 || channels > 4){
@@ -100,11 +464,13 @@ void ofxPixelBuffer::allocate(int width, int height, int channels, int frames){
     }
 
     if (width*height*channels > 0 && frames > 0) {
+        clearFrames();
+        freeStorage();
         myWidth = width;
         myHeight = height;
         myChannels = channels;
-        myFrameSize = width * height * channels;
-        myBuffer.clear();
+        myFrameSize = width * height * channels * sizeof(T);
+        mySize = 0;
         bAllocated = true;
 		// resize buffer and allocate ofPixels
         resize(frames);
@@ -114,36 +480,153 @@ void ofxPixelBuffer::allocate(int width, int height, int channels, int frames){
     }
 }
 
-void ofxPixelBuffer::allocate(const ofPixels& pix, int frames){
+template<typename T>
+void ofxPixelBuffer_<T>::allocate(const ofPixels_<T>& pix, int frames){
     allocate(pix.getWidth(), pix.getHeight(), pix.getNumChannels(), frames);
 }
 
-void ofxPixelBuffer::resize(int newSize){
+template<typename T>
+void ofxPixelBuffer_<T>::resize(int newSize){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (bAllocated){
+        newSize = max(0, newSize);
         int oldSize = mySize;
-        int diff = newSize - oldSize;
-        myBuffer.resize(newSize);
-        mySize = newSize;
+        if (newSize < oldSize){
+            for (int i = newSize; i < oldSize; ++i){
+                releaseFrame(myBuffer[i]);
+            }
+            myBuffer.resize(newSize);
+        }
 		// allocate ofPixels if new size is larger than old size
-        if (diff > 0){
-            for(int i = 0; i<diff; ++i){
-                ofPixels& pixRef = myBuffer[oldSize+i];
-                pixRef.allocate(myWidth, myHeight, myChannels);
-
-                unsigned char * pix = pixRef.getData();
-                for (uint32_t i = 0; i < myFrameSize; ++i){
-                    pix[i] = 0;
-                }
+        else if (newSize > oldSize){
+            // slab storage: grow only once
+            reserve(newSize);
+            myBuffer.resize(newSize);
+            for (int i = oldSize; i < newSize; ++i){
+                myBuffer[i] = newFrame();
+                memset(myBuffer[i].getData(), 0, myFrameSize);
             }
         }
+        mySize = newSize;
     }
     else {
         cout << "not allocated yet!\n";
     }
 }
 
-void ofxPixelBuffer::clearBuffer(){
-    myBuffer.clear();
+template<typename T>
+void ofxPixelBuffer_<T>::reserve(int frames){
+    if (!checkWritable()){
+        return;
+    }
+    if (!bAllocated){
+        cout << "not allocated yet!\n";
+        return;
+    }
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB && frames > mySlabFrames){
+        growSlab(frames - mySlabFrames);
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::setStorage(ofxPixelBufferStorage storage){
+    if (storage == myStorage){
+        return;
+    }
+    if (storage == OFX_PIXEL_BUFFER_STORAGE_MAPPED){
+        cout << "use loadMapped() to map a file!\n";
+        return;
+    }
+    if (storage == OFX_PIXEL_BUFFER_STORAGE_STREAMED){
+        cout << "use loadStreamed() to stream a file!\n";
+        return;
+    }
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_COMPRESSED || myStorage == OFX_PIXEL_BUFFER_STORAGE_DELTA){
+        // decode all frames into slab or frame storage
+        unique_ptr<ofxPixelBufferCompressedFrames_<T>> compressed = move(myCompressed);
+        unique_ptr<ofxPixelBufferDeltaFrames_<T>> delta = move(myDelta);
+        myStorage = (storage == OFX_PIXEL_BUFFER_STORAGE_SLAB) ? storage : OFX_PIXEL_BUFFER_STORAGE_FRAMES;
+        reserve(mySize);
+        for (int i = 0; i < mySize; ++i){
+            myBuffer.push_back(newFrame());
+            if (compressed){
+                compressed->decode(i, myBuffer.back().getData());
+            } else {
+                delta->decode(i, myBuffer.back().getData());
+            }
+        }
+        // switching between compressed and delta storage
+        if (storage != myStorage){
+            setStorage(storage);
+        }
+        return;
+    }
+    if (!checkWritable()){
+        return;
+    }
+    if (storage == OFX_PIXEL_BUFFER_STORAGE_COMPRESSED || storage == OFX_PIXEL_BUFFER_STORAGE_DELTA){
+        if (!bAllocated){
+            cout << "buffer not allocated!\n";
+            return;
+        }
+        unique_ptr<ofxPixelBufferCompressedFrames_<T>> compressed;
+        unique_ptr<ofxPixelBufferDeltaFrames_<T>> delta;
+        if (storage == OFX_PIXEL_BUFFER_STORAGE_COMPRESSED){
+            compressed.reset(new ofxPixelBufferCompressedFrames_<T>(myWidth, myHeight, myChannels));
+        } else {
+            delta.reset(new ofxPixelBufferDeltaFrames_<T>(myWidth, myHeight, myChannels, myKeyframeInterval, myTileSize));
+        }
+        for (auto& frame : myBuffer){
+            if (compressed){
+                compressed->pushBack(frame.getData());
+            } else {
+                delta->pushBack(frame.getData());
+            }
+        }
+        clearFrames();
+        freeStorage();
+        myStorage = storage;
+        myCompressed = move(compressed);
+        myDelta = move(delta);
+        return;
+    }
+    if (storage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+        myStorage = storage;
+        if (bAllocated){
+            // copy the frames into the slab
+            reserve(mySize);
+            for (auto& frame : myBuffer){
+                ofPixels_<T> view = newFrame();
+                memcpy(view.getData(), frame.getData(), myFrameSize);
+                OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+                releaseFrame(frame);
+                frame = move(view);
+            }
+        }
+        myMapping.reset();
+    } else {
+        // give every frame a block of its own before releasing the slab
+        for (auto& frame : myBuffer){
+            if (!myBlocks.count(frame.getData())){
+                ofPixels_<T> copy = acquireFrame();
+                memcpy(copy.getData(), frame.getData(), myFrameSize);
+                OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+                frame = adoptFrame(move(copy));
+            }
+        }
+        freeStorage();
+        myStorage = storage;
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::clearBuffer(){
+    myVersion++;
+    clearFrames();
+    freeStorage();
     myWidth = 0;
     myHeight = 0;
     myChannels = 0;
@@ -152,16 +635,28 @@ void ofxPixelBuffer::clearBuffer(){
     bAllocated = false;
 }
 
-void ofxPixelBuffer::clearPixels(){
+template<typename T>
+void ofxPixelBuffer_<T>::clearPixels(){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB && mySlab){
+        // one pass over the whole slab (free slots included)
+        memset(mySlab, 0, mySlabFrames * mySlabStride);
+        return;
+    }
     for(int i = 0; i < mySize; ++i){
-        unsigned char * pix = myBuffer[i].getData();
-        for (uint32_t i = 0; i < myFrameSize; ++i){
-            pix[i] = 0;
-        }
+        memset(unshareFrame(i, false).getData(), 0, myFrameSize);
     }
 }
 
-bool ofxPixelBuffer::loadImage(const string filePath, int bufferIndex){
+template<typename T>
+bool ofxPixelBuffer_<T>::loadImage(const string filePath, int bufferIndex){
+    myVersion++;
+    if (!checkWritable()){
+        return false;
+    }
     if (!bAllocated){
         cout << "not allocated!\n";
         return false;
@@ -171,7 +666,7 @@ bool ofxPixelBuffer::loadImage(const string filePath, int bufferIndex){
         return false;
     }
 
-    ofImage image;
+    ofImage_<T> image;
     image.setUseTexture(false);
 
     if (image.load(filePath)){
@@ -185,7 +680,7 @@ bool ofxPixelBuffer::loadImage(const string filePath, int bufferIndex){
         }
 
         bufferIndex = max(0, min(mySize-1, bufferIndex));
-        myBuffer[bufferIndex] = image.getPixels();
+        memcpy(unshareFrame(bufferIndex, false).getData(), image.getPixels().getData(), myFrameSize);
 
         return true;
     } else {
@@ -194,11 +689,95 @@ bool ofxPixelBuffer::loadImage(const string filePath, int bufferIndex){
 }
 
 
-int ofxPixelBuffer::loadMultiImage(const string filePath, int numFiles, int startIndex, int bufferOnset){
-    ofImage image;
-    // we don't need to load the image into a texture.
-    image.setUseTexture(false);
+// decodes the files [startIndex, endIndex) of a wildcard sequence and hands them to 'consume'
+// in index order on the calling thread ('pixels' is nullptr if the file couldn't be loaded).
+// with more than one thread the files are decoded on a worker pool, with a bounded number
+// of decoded frames in flight. 'consume' returns false to stop loading.
+template<typename T>
+static void decodeImageSequence(const string& filePath, size_t position, int startIndex, int endIndex, int numThreads,
+                                const function<bool(const string& path, ofPixels_<T>* pixels)>& consume){
+    auto makePath = [&](int i){
+        string newPath = filePath;
+        newPath.replace(position, 1, ofToString(i));
+        return newPath;
+    };
+
+    if (numThreads <= 1){
+        ofPixels_<T> pixels;
+        for (int i = startIndex; i < endIndex; ++i){
+            string path = makePath(i);
+            if (!consume(path, ofLoadImage(pixels, path) ? &pixels : nullptr)){
+                break;
+            }
+        }
+        return;
+    }
+
+    struct Result {
+        bool ok;
+        ofPixels_<T> pixels;
+    };
+    mutex mtx;
+    condition_variable cond;
+    map<int, Result> results; // decoded frames waiting to be consumed
+    int next = startIndex; // next index to decode
+    int consumed = startIndex; // next index to consume
+    const int window = numThreads * 2;
+    bool stop = false;
+
+    auto worker = [&](){
+        unique_lock<mutex> lock(mtx);
+        while (true){
+            cond.wait(lock, [&](){ return stop || next >= endIndex || next < consumed + window; });
+            if (stop || next >= endIndex){
+                return;
+            }
+            int i = next++;
+            lock.unlock();
+            Result result;
+            result.ok = ofLoadImage(result.pixels, makePath(i));
+            lock.lock();
+            results[i] = move(result);
+            cond.notify_all();
+        }
+    };
+
+    vector<thread> threads;
+    for (int i = 0; i < numThreads; ++i){
+        threads.emplace_back(worker);
+    }
+
+    for (int i = startIndex; i < endIndex; ++i){
+        Result result;
+        {
+            unique_lock<mutex> lock(mtx);
+            cond.wait(lock, [&](){ return results.count(i) > 0; });
+            result = move(results[i]);
+            results.erase(i);
+            consumed = i + 1;
+        }
+        cond.notify_all();
+        if (!consume(makePath(i), result.ok ? &result.pixels : nullptr)){
+            break;
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(mtx);
+        stop = true;
+    }
+    cond.notify_all();
+    for (auto& t : threads){
+        t.join();
+    }
+}
 
+template<typename T>
+int ofxPixelBuffer_<T>::loadMultiImage(const string filePath, int numFiles, int startIndex, int bufferOnset, int numThreads){
+    myVersion++;
+    if (!checkWritable()){
+        return -1;
+    }
     auto position = filePath.find("*");
 
     if (position == string::npos){
@@ -206,6 +785,10 @@ int ofxPixelBuffer::loadMultiImage(const string filePath, int numFiles, int star
         return -1; // couldn't find wildcard
     }
 
+    if (numThreads == 0){
+        numThreads = max(1u, thread::hardware_concurrency());
+    }
+
     // counter for actually loaded images.
     // all images have to have the same dimension.
     // images with wrong dimensions are skipped.
@@ -216,43 +799,41 @@ int ofxPixelBuffer::loadMultiImage(const string filePath, int numFiles, int star
     // special case: buffer is empty
     // load images and push_back
     if (mySize == 0){
-        myBuffer.clear();
+        clearFrames();
+        freeStorage();
 
         startIndex = (startIndex < 0) ? 0 : startIndex;
         int endIndex = (numFiles < 0) ? 1000000 : numFiles + startIndex;
+        bool first = true;
 
-        for (int i = startIndex; i < endIndex; ++i){
-            string newPath = filePath;
-            newPath.replace(position, 1, ofToString(i));
-
-            // try to load image
-            if (image.load(newPath)){
-                int width = image.getWidth();
-                int height = image.getHeight();
-                int channels = image.getPixels().getNumChannels();
-                // first image determines the dimensions
-                if (i == startIndex){
-                    myWidth = width;
-                    myHeight = height;
-                    myChannels = channels;
-                    myFrameSize = width*height*channels;
-                    bAllocated = true;
-                    myBuffer.push_back(image.getPixels());
-                    k++;
-                }
-                // compare with dimensions of the first image
-                else if ((width != myWidth)||(height != myHeight)||(channels != myChannels)){
-                    cout << "skip " << newPath << " - wrong dimension!\n";
-                }
-                else {
-                    myBuffer.push_back(image.getPixels());
-                    k++;
-                }
-            } else {
+        decodeImageSequence<T>(filePath, position, startIndex, endIndex, numThreads,
+                            [&](const string& newPath, ofPixels_<T>* pixels){
+            if (!pixels){
                 // couldn't find any more images, stop looping
-                break;
+                return false;
             }
-        }
+            int width = pixels->getWidth();
+            int height = pixels->getHeight();
+            int channels = pixels->getNumChannels();
+            // first image determines the dimensions
+            if (first){
+                myWidth = width;
+                myHeight = height;
+                myChannels = channels;
+                myFrameSize = width*height*channels*sizeof(T);
+                bAllocated = true;
+                first = false;
+            }
+            // compare with dimensions of the first image
+            else if ((width != myWidth)||(height != myHeight)||(channels != myChannels)){
+                cout << "skip " << newPath << " - wrong dimension!\n";
+                return true;
+            }
+            myBuffer.push_back(newFrame());
+            memcpy(myBuffer.back().getData(), pixels->getData(), myFrameSize);
+            k++;
+            return true;
+        });
         // update buffer size variable
         mySize = k;
     }
@@ -272,35 +853,160 @@ int ofxPixelBuffer::loadMultiImage(const string filePath, int numFiles, int star
         startIndex = (startIndex < 0) ? 0 : startIndex;
         int endIndex = numFiles + startIndex;
 
-        for (int i = startIndex; i < endIndex; ++i){
-            string newPath = filePath;
+        decodeImageSequence<T>(filePath, position, startIndex, endIndex, numThreads,
+                            [&](const string& newPath, ofPixels_<T>* pixels){
+            if (!pixels){
+                // just skip path, continue looping
+                cout << "failed to load " << newPath << "!\n";
+            }
+            else if ((pixels->getWidth() != myWidth)||(pixels->getHeight() != myHeight)||(pixels->getNumChannels() != myChannels)){
+                cout << "skip " << newPath << " - wrong dimension!\n";
+            }
+            else {
+                memcpy(unshareFrame(k + bufferOnset, false).getData(), pixels->getData(), myFrameSize);
+                k++;
+            }
+            return true;
+        });
+    }
+
+    return k; // return number of successfully loaded images
 
-            newPath.replace(position, 1, ofToString(i));
+}
+
+template<typename T>
+vector<bool> ofxPixelBuffer_<T>::saveMultiImage(const string filePath, int frameOnset, int numFrames, int startIndex,
+                                                ofImageQualityType quality, int numThreads) const {
+    auto position = filePath.find("*");
+
+    if (position == string::npos){
+        cout << "path must contain wildcard [*]!\n";
+        return vector<bool>();
+    }
+    if (mySize == 0){
+        cout << "buffer is empty!\n";
+        return vector<bool>();
+    }
+
+    frameOnset = max(0, min(mySize-1, frameOnset));
+    if (numFrames < 0 || numFrames > mySize - frameOnset){
+        numFrames = mySize - frameOnset;
+    }
+    startIndex = (startIndex < 0) ? 0 : startIndex;
+    if (numThreads == 0){
+        numThreads = max(1u, thread::hardware_concurrency());
+    }
+
+    auto makePath = [&](int i){
+        string newPath = filePath;
+        newPath.replace(position, 1, ofToString(startIndex + i));
+        return newPath;
+    };
+    vector<char> results(numFrames, 0); // not vector<bool>, the workers write concurrently
 
-            if (image.load(newPath)){
-                if ((image.getWidth() != myWidth)||(image.getHeight() != myHeight)||(image.getPixels().getNumChannels() != myChannels)){
-                    cout << "skip " << newPath << " - wrong dimension!\n";
+    if (numThreads <= 1){
+        for (int i = 0; i < numFrames; ++i){
+            results[i] = ofSaveImage(getFrame(frameOnset + i), makePath(i), quality);
+        }
+    } else {
+        // frame, slab and mapped frames stay in place, so the workers read them directly.
+        // streamed, compressed and delta frames only live in a cache, so they are copied
+        // on this thread, with a bounded number of copies in flight.
+        bool copy = myStream || myCompressed || myDelta;
+        struct Job {
+            int index;
+            const ofPixels_<T>* pixels; // nullptr = use 'copy'
+            ofPixels_<T> copy;
+        };
+        mutex mtx;
+        condition_variable cond;
+        deque<Job> jobs;
+        int copies = 0; // copies queued or being encoded
+        const int window = numThreads * 2;
+        bool done = false;
+
+        auto worker = [&](){
+            unique_lock<mutex> lock(mtx);
+            while (true){
+                cond.wait(lock, [&](){ return done || !jobs.empty(); });
+                if (jobs.empty()){
+                    return;
                 }
-                else {
-                    myBuffer[k + bufferOnset] = image.getPixels();
-                    k++;
+                Job job = move(jobs.front());
+                jobs.pop_front();
+                lock.unlock();
+                results[job.index] = ofSaveImage(job.pixels ? *job.pixels : job.copy, makePath(job.index), quality);
+                if (!job.pixels){
+                    myPool->release(move(job.copy));
                 }
+                lock.lock();
+                if (!job.pixels){
+                    copies--;
+                    cond.notify_all();
+                }
+            }
+        };
+
+        vector<thread> threads;
+        for (int i = 0; i < numThreads; ++i){
+            threads.emplace_back(worker);
+        }
+
+        for (int i = 0; i < numFrames; ++i){
+            Job job;
+            job.index = i;
+            job.pixels = nullptr;
+            if (copy){
+                {
+                    unique_lock<mutex> lock(mtx);
+                    cond.wait(lock, [&](){ return copies < window; });
+                    copies++;
+                }
+                job.copy = myPool->acquire(myWidth, myHeight, myChannels);
+                memcpy(job.copy.getData(), getFrame(frameOnset + i).getData(), myFrameSize);
+                OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
             } else {
-                // just skip path, continue looping
-                cout << "failed to load " << newPath << "!\n";
+                job.pixels = &getFrame(frameOnset + i);
             }
+            {
+                lock_guard<mutex> lock(mtx);
+                jobs.push_back(move(job));
+            }
+            cond.notify_all();
         }
-    }
 
-    return k; // return number of successfully loaded images
+        {
+            lock_guard<mutex> lock(mtx);
+            done = true;
+        }
+        cond.notify_all();
+        for (auto& t : threads){
+            t.join();
+        }
+    }
 
+    vector<bool> saved(numFrames);
+    for (int i = 0; i < numFrames; ++i){
+        saved[i] = results[i] != 0;
+        if (!saved[i]){
+            cout << "failed to save " << makePath(i) << "!\n";
+        }
+    }
+    return saved;
 }
 
 
-bool ofxPixelBuffer::loadMovie(const string filePath, int numFrames, int frameOnset, int bufferOnset){
+// opens the movie and prepares the buffer. returns the number of frames to decode (-1 on failure)
+// and the buffer index of the first frame in 'bufferOnset'.
+template<typename T>
+int ofxPixelBuffer_<T>::openMovie(const string& filePath, int numFrames, int frameOnset, int& bufferOnset){
+    myVersion++;
+    if (!checkWritable()){
+        return -1;
+    }
     if (!myLoader){
         cout << "set movie loader first!\n";
-        return false;
+        return -1;
     }
     // check if loader is ofVideoPlayer
     if (auto* v = dynamic_cast<ofVideoPlayer*>(myLoader)){
@@ -333,86 +1039,388 @@ bool ofxPixelBuffer::loadMovie(const string filePath, int numFrames, int frameOn
             numFrames = max(1, min(numFrames, myLoader->getTotalNumFrames() - frameOnset));
         }
 
+        int length;
         // special case: buffer is empty, therefore resize the buffer to the number of frames and load everything
         if (mySize == 0) {
             allocate(width, height, channels, numFrames);
-            // necessary on some threaded players (DS)
-            if (bThreaded){
-                myLoader->setSpeed(0);
-                myLoader->play();
-            }
-            myLoader->setFrame(frameOnset);
-
-            for (int i = 0; i < numFrames; ++i){
-                // if threaded, wait till new frame has been loaded
-                if (bThreaded){
-                    while (true){
-                        myLoader->update();
-                        if (myLoader->isFrameNew()){
-                            cout << "loaded frame " << myLoader->getCurrentFrame() << "\n";
-                            break;
-                        }
-                    }
-                }
-                myBuffer[i] = myLoader->getPixels();
-                myLoader->nextFrame();
-            }
+            bufferOnset = 0;
+            length = numFrames;
         }
         // default case: buffer is not empty, so we can write frames to it.
         else {
             if (!bAllocated){
                 cout << "buffer not allocated!\n";
                 myLoader->close();
-                return false;
+                return -1;
             }
 
             if ((width != myWidth)||(height != myHeight)||(channels != myChannels)){
                 cout << "wrong dimension!";
                 myLoader->close();
-                return false;
+                return -1;
             }
 
             bufferOnset = max(0, min(mySize-1, bufferOnset));
-            int length = min(mySize - bufferOnset, numFrames);
-            // necessary on some threaded players (DS)
-            if (bThreaded){
-                myLoader->setSpeed(0);
-                myLoader->play();
-            }
-            myLoader->setFrame(frameOnset);
-
-            for (int i = 0; i < length; ++i){
-                // if threaded, wait till new frame has been loaded
-                if (bThreaded){
-                    while (true){
-                        myLoader->update();
-                        if (myLoader->isFrameNew()){
-                            cout << "loaded frame " << myLoader->getCurrentFrame() << "\n";
-                            break;
-                        }
-                    }
-                }
-                myBuffer[i+bufferOnset] = myLoader->getPixels();
-                myLoader->nextFrame();
+            length = min(mySize - bufferOnset, numFrames);
+            // the frames may be decoded on another thread, so copy shared frames here
+            for (int i = bufferOnset; i < bufferOnset + length; ++i){
+                unshareFrame(i);
             }
         }
-        // movie was successfully written into the buffer
-        myLoader->close();
-        return true;
-    } else {
+        // necessary on some threaded players (DS)
+        if (bThreaded){
+            myLoader->setSpeed(0);
+            myLoader->play();
+        }
+        myLoader->setFrame(frameOnset);
+
+        myLoadOnset = bufferOnset;
+        myFramesToLoad = length;
+        myLoadedFrames = 0;
+        return length;
+    } else {
         // couldn't load movie
         cout << "couldn't load movie!\n";
         myLoader->close();
+        return -1;
+    }
+}
+
+// copies 'length' frames from the movie loader into the buffer. returns false if cancelled.
+template<typename T>
+bool ofxPixelBuffer_<T>::decodeMovie(int bufferOnset, int length){
+    for (int i = 0; i < length; ++i){
+        if (bCancelLoad){
+            return false;
+        }
+        // if threaded, wait till new frame has been loaded.
+        // the player decodes in the background, so we poll without burning a core.
+        if (bThreaded){
+            while (true){
+                myLoader->update();
+                if (myLoader->isFrameNew()){
+                    break;
+                }
+                if (bCancelLoad){
+                    return false;
+                }
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+        copyPixels(myLoader->getPixels().getData(), myBuffer[i+bufferOnset].getData(), myFrameSize / sizeof(T));
+        // publish the frame
+        myLoadedFrames.store(i + 1, memory_order_release);
+        myLoader->nextFrame();
+    }
+    return true;
+}
+
+template<typename T>
+bool ofxPixelBuffer_<T>::loadMovie(const string filePath, int numFrames, int frameOnset, int bufferOnset){
+    // a new load replaces a pending asynchronous one
+    cancelLoad();
+
+    int length = openMovie(filePath, numFrames, frameOnset, bufferOnset);
+    if (length < 0){
         return false;
     }
+    decodeMovie(bufferOnset, length);
+    // movie was successfully written into the buffer
+    myLoader->close();
+    return true;
+}
+
+template<typename T>
+shared_future<bool> ofxPixelBuffer_<T>::loadMovieAsync(const string filePath, int numFrames, int frameOnset, int bufferOnset,
+                                                   function<void(bool)> callback){
+    cancelLoad();
+
+    auto result = make_shared<promise<bool>>();
+    shared_future<bool> future = result->get_future().share();
+
+    // open the movie and allocate the buffer on the calling thread,
+    // so the buffer has its final size when we return.
+    int length = openMovie(filePath, numFrames, frameOnset, bufferOnset);
+    if (length < 0){
+        result->set_value(false);
+        if (callback){
+            callback(false);
+        }
+        return future;
+    }
+
+    bLoading = true;
+    // the callback may look at myLoadThread (see joinLoader), so wait until it has been assigned
+    auto started = make_shared<promise<void>>();
+    shared_future<void> assigned = started->get_future().share();
+    myLoadThread = thread([this, bufferOnset, length, result, callback, assigned](){
+        assigned.wait();
+        bool success = decodeMovie(bufferOnset, length);
+        myLoader->close();
+        bLoading = false;
+        result->set_value(success);
+        if (callback){
+            callback(success);
+        }
+    });
+    started->set_value();
+    return future;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::cancelLoad(){
+    if (myLoadThread.joinable()){
+        bCancelLoad = true;
+        joinLoader(myLoadThread);
+        bCancelLoad = false;
+    }
+}
+
+template<typename T>
+bool ofxPixelBuffer_<T>::isFrameLoading(int index) const {
+    return bLoading && index >= myLoadOnset + getNumLoadedFrames() && index < myLoadOnset + myFramesToLoad;
+}
+
+template<typename T>
+float ofxPixelBuffer_<T>::getLoadProgress() const {
+    int total = myFramesToLoad;
+    return (total > 0) ? static_cast<float>(myLoadedFrames) / total : 0.f;
 }
 
-void ofxPixelBuffer::setMovieLoader(ofBaseVideoPlayer &loader, bool isThreaded){
+template<typename T>
+void ofxPixelBuffer_<T>::setMovieLoader(ofBaseVideoPlayer &loader, bool isThreaded){
     myLoader = &loader;
     bThreaded = isThreaded;
 }
 
-void ofxPixelBuffer::write(int index, const ofPixels& myPixels){
+template<typename T>
+bool ofxPixelBuffer_<T>::checkWritable() const {
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_STREAMED){
+        cout << "streamed buffer is read-only!\n";
+        return false;
+    }
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_COMPRESSED){
+        cout << "compressed buffer can only be changed with write()!\n";
+        return false;
+    }
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_DELTA){
+        cout << "delta encoded buffer can only be changed with write()!\n";
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+const ofPixels_<T>& ofxPixelBuffer_<T>::getFrame(int index) const {
+    if (myStream){
+        return myStream->getFrame(index);
+    }
+    if (myCompressed){
+        return myCompressed->getFrame(index);
+    }
+    if (myDelta){
+        return myDelta->getFrame(index);
+    }
+    return myBuffer[index];
+}
+
+template<typename T>
+bool ofxPixelBuffer_<T>::save(const string filePath) const {
+    if (!bAllocated){
+        cout << "buffer not allocated!\n";
+        return false;
+    }
+
+    FILE* file = fopen(ofToDataPath(filePath).c_str(), "wb");
+    if (!file){
+        cout << "couldn't open " << filePath << "!\n";
+        return false;
+    }
+
+    ofxPixelBufferFileHeader header(myWidth, myHeight, myChannels, sizeof(T), mySize);
+    vector<char> padding(header.frameStride - header.frameSize, 0);
+    bool success = ofxPixelBufferWriteFileHeader(file, header);
+    for (int i = 0; i < mySize && success; ++i){
+        success = (fwrite(read(i).getData(), 1, myFrameSize, file) == myFrameSize)
+            && (fwrite(padding.data(), 1, padding.size(), file) == padding.size());
+    }
+    if (fclose(file) != 0 || !success){
+        cout << "couldn't write " << filePath << "!\n";
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool ofxPixelBuffer_<T>::loadMapped(const string filePath){
+    myVersion++;
+    auto mapping = make_shared<ofxPixelBufferFileMapping>();
+    if (!mapping->open(ofToDataPath(filePath))){
+        cout << "couldn't open " << filePath << "!\n";
+        return false;
+    }
+
+    ofxPixelBufferFileHeader header;
+    if (mapping->getSize() >= sizeof(header)){
+        memcpy(&header, mapping->getData(), sizeof(header));
+    }
+    if (!header.isValid() || header.bytesPerChannel != sizeof(T)
+            || !header.fitsInto(mapping->getSize())){
+        cout << "bad file: " << filePath << "!\n";
+        return false;
+    }
+
+    cancelLoad();
+    clearFrames();
+    freeStorage();
+    myWidth = header.width;
+    myHeight = header.height;
+    myChannels = header.channels;
+    myFrameSize = header.frameSize;
+    myStorage = OFX_PIXEL_BUFFER_STORAGE_MAPPED;
+    myMapping = mapping;
+    for (uint64_t i = 0; i < header.numFrames; ++i){
+        ofPixels_<T> view;
+        view.setFromExternalPixels(reinterpret_cast<T*>(mapping->getData() + header.getFrameOffset(i)), myWidth, myHeight, myChannels);
+        myBuffer.push_back(move(view));
+    }
+    mySize = myBuffer.size();
+    bAllocated = true;
+    return true;
+}
+
+template<typename T>
+bool ofxPixelBuffer_<T>::loadStreamed(const string filePath, int cacheFrames){
+    myVersion++;
+    unique_ptr<ofxPixelBufferStream_<T>> stream(new ofxPixelBufferStream_<T>());
+    if (!stream->open(ofToDataPath(filePath), cacheFrames)){
+        cout << "couldn't open " << filePath << "!\n";
+        return false;
+    }
+
+    cancelLoad();
+    clearFrames();
+    freeStorage();
+    const ofxPixelBufferFileHeader& header = stream->getHeader();
+    myWidth = header.width;
+    myHeight = header.height;
+    myChannels = header.channels;
+    myFrameSize = header.frameSize;
+    mySize = header.numFrames;
+    myStorage = OFX_PIXEL_BUFFER_STORAGE_STREAMED;
+    myStream = move(stream);
+    bAllocated = true;
+    return true;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::prefetch(const vector<int>& frames){
+    if (myStream){
+        myStream->prefetch(frames);
+    }
+}
+
+template<typename T>
+int ofxPixelBuffer_<T>::getPrefetchDepth() const {
+    return myStream ? myStream->getPrefetchDepth() : 0;
+}
+
+template<typename T>
+ofxPixelBufferStreamStats ofxPixelBuffer_<T>::getStreamStats() const {
+    if (myStream){
+        return myStream->getStats();
+    }
+    ofxPixelBufferStreamStats stats = ofxPixelBufferStreamStats();
+    return stats;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::resetStreamStats(){
+    if (myStream){
+        myStream->resetStats();
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::setCompressionCacheSize(int frames){
+    if (myCompressed){
+        myCompressed->setCacheSize(frames);
+    } else {
+        cout << "buffer is not compressed!\n";
+    }
+}
+
+template<typename T>
+int ofxPixelBuffer_<T>::getCompressionCacheSize() const {
+    return myCompressed ? myCompressed->getCacheSize() : 0;
+}
+
+template<typename T>
+ofxPixelBufferCompressionStats ofxPixelBuffer_<T>::getCompressionStats() const {
+    if (myCompressed){
+        return myCompressed->getStats();
+    }
+    ofxPixelBufferCompressionStats stats = ofxPixelBufferCompressionStats();
+    return stats;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::resetCompressionStats(){
+    if (myCompressed){
+        myCompressed->resetStats();
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::setKeyframeInterval(int frames){
+    myKeyframeInterval = max(0, frames);
+    if (myDelta){
+        myDelta->setKeyframeInterval(myKeyframeInterval);
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::setDeltaCacheSize(int frames){
+    if (myDelta){
+        myDelta->setCacheSize(frames);
+    } else {
+        cout << "buffer is not delta encoded!\n";
+    }
+}
+
+template<typename T>
+int ofxPixelBuffer_<T>::getDeltaCacheSize() const {
+    return myDelta ? myDelta->getCacheSize() : 0;
+}
+
+template<typename T>
+ofxPixelBufferDeltaStats ofxPixelBuffer_<T>::getDeltaStats() const {
+    if (myDelta){
+        return myDelta->getStats();
+    }
+    ofxPixelBufferDeltaStats stats = ofxPixelBufferDeltaStats();
+    return stats;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::resetDeltaStats(){
+    if (myDelta){
+        myDelta->resetStats();
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::setFramePool(shared_ptr<ofxPixelBufferFramePool_<T>> pool){
+    myPool = pool ? pool : make_shared<ofxPixelBufferFramePool_<T>>();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::write(int index, const ofPixels_<T>& myPixels){
+    myVersion++;
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_WRITE);
+    if (!myCompressed && !myDelta && !checkWritable()){
+        return;
+    }
     if (mySize == 0){
         cout << "buffer has no frames!\n";
         return;
@@ -427,14 +1435,79 @@ void ofxPixelBuffer::write(int index, const ofPixels& myPixels){
     }
 
     index = max(0, min(mySize-1, index));
-    myBuffer[index] = myPixels;
+    if (isFrameLoading(index)){
+        cout << "frame is still loading!\n";
+        return;
+    }
+    if (myCompressed){
+        myCompressed->write(index, myPixels.getData());
+    } else if (myDelta){
+        myDelta->write(index, myPixels.getData());
+    } else {
+        memcpy(unshareFrame(index, false).getData(), myPixels.getData(), myFrameSize);
+        OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+    }
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::write(int index, ofPixels_<T>&& myPixels){
+    myVersion++;
+    if (myStorage != OFX_PIXEL_BUFFER_STORAGE_FRAMES){
+        // slab frames can't change their memory
+        write(index, static_cast<const ofPixels_<T>&>(myPixels));
+        return;
+    }
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_WRITE);
+    if (mySize == 0){
+        cout << "buffer has no frames!\n";
+        return;
+    }
+
+    if ((myPixels.getWidth() != myWidth)||
+        (myPixels.getHeight() != myHeight)||
+        (myPixels.getNumChannels() != myChannels)
+        ){
+        cout << "wrong dimension!\n";
+        return;
+    }
+
+    index = max(0, min(mySize-1, index));
+    if (isFrameLoading(index)){
+        cout << "frame is still loading!\n";
+        return;
+    }
+    // a shared frame is handed back as a copy
+    ofPixels_<T> oldPixels = takeFrame(myBuffer[index]);
+    myBuffer[index] = adoptFrame(move(myPixels));
+    myPixels = move(oldPixels);
+}
+
+template<typename T>
+ofPixels_<T>& ofxPixelBuffer_<T>::getWritable(int index){
+    myVersion++;
+    if (!checkWritable()){
+        return dummy;
+    }
+    if (mySize > 0){
+        index = max(0, min(mySize-1, index));
+        if (isFrameLoading(index)){
+            cout << "frame is still loading!\n";
+            return dummy;
+        }
+        return unshareFrame(index);
+    }
+    else {
+        cout << "buffer is empty!\n";
+        return dummy;
+    }
 }
 
 
-const ofPixels& ofxPixelBuffer::read (int index) const {
+template<typename T>
+const ofPixels_<T>& ofxPixelBuffer_<T>::read (int index) const {
     if (mySize > 0){
         index = max(0, min(mySize-1, index));
-        return myBuffer[index];
+        return getFrame(index);
     }
     else {
         cout << "buffer is empty!\n";
@@ -442,10 +1515,11 @@ const ofPixels& ofxPixelBuffer::read (int index) const {
     }
 }
 
-const ofPixels& ofxPixelBuffer::operator[] (int index) const {
+template<typename T>
+const ofPixels_<T>& ofxPixelBuffer_<T>::operator[] (int index) const {
     if (mySize > 0){
         index = max(0, min(mySize-1, index));
-        return myBuffer[index];
+        return getFrame(index);
     }
     else {
         cout << "buffer is empty!\n";
@@ -454,84 +1528,239 @@ const ofPixels& ofxPixelBuffer::operator[] (int index) const {
 }
 
 
-ofPixels ofxPixelBuffer::readLinear (float index) const {
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::readLinear (float index) const {
+    ofPixels_<T> temp;
+    readLinearInto(index, temp);
+    return temp;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::readLinearInto (float index, ofPixels_<T>& out) const {
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_READ_LINEAR);
     if (mySize > 0){
         index = max(0.f, min(mySize-0.0001f, index));
         int intPart = static_cast<int>(index);
         float floatPart = index-intPart;
 
-        const unsigned char* pix1 = myBuffer[intPart].getData();
-        const unsigned char* pix2 = myBuffer[(intPart+1)%mySize].getData();
-        ofPixels temp;
-        temp.allocate(myWidth, myHeight, myChannels);
-        unsigned char* result = temp.getData();
+        // streamed, compressed and delta storage keep the last frames pinned,
+        // so pix1 stays valid while fetching pix2
+        const T* pix1 = getFrame(intPart).getData();
+        const T* pix2 = getFrame((intPart+1)%mySize).getData();
+        // only (re)allocate if the dimensions don't match
+        if ((out.getWidth() != myWidth)||(out.getHeight() != myHeight)||(out.getNumChannels() != myChannels)){
+            out.allocate(myWidth, myHeight, myChannels);
+        }
 
-        float a = 1 - floatPart;
-        float b = floatPart;
+        // vectorized fixed-point blend
+        myKernels->lerp(pix1, pix2, out.getData(), myFrameSize / sizeof(T), floatPart);
+        OFX_PIXEL_BUFFER_COUNT_LERP(myCounters);
+    }
+    else {
+        cout << "buffer is empty!\n";
+        out.clear(); // return empty pixels
+    }
+}
 
-        for (uint32_t i = 0; i < myFrameSize; ++i){
-            result[i] = static_cast<unsigned char>(pix1[i] * a + pix2[i] * b);
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::readCubic (float index) const {
+    ofPixels_<T> temp;
+    readCubicInto(index, temp);
+    return temp;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::readCubicInto (float index, ofPixels_<T>& out) const {
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_READ_CUBIC);
+    if (mySize > 0){
+        index = max(0.f, min(mySize-0.0001f, index));
+        int intPart = static_cast<int>(index);
+        float floatPart = index-intPart;
+
+        // the neighbours wrap around like in readLinearInto.
+        // streamed, compressed and delta storage pin the last 4 frames, so all pointers stay valid
+        const T* pix0 = getFrame((intPart+mySize-1)%mySize).getData();
+        const T* pix1 = getFrame(intPart).getData();
+        const T* pix2 = getFrame((intPart+1)%mySize).getData();
+        const T* pix3 = getFrame((intPart+2)%mySize).getData();
+        if ((out.getWidth() != myWidth)||(out.getHeight() != myHeight)||(out.getNumChannels() != myChannels)){
+            out.allocate(myWidth, myHeight, myChannels);
         }
 
-        return temp;
+        myKernels->cubic(pix0, pix1, pix2, pix3, out.getData(), myFrameSize / sizeof(T), floatPart);
+        OFX_PIXEL_BUFFER_COUNT_LERP(myCounters);
     }
     else {
         cout << "buffer is empty!\n";
-        return ofPixels(); // return empty pixels
+        out.clear(); // return empty pixels
     }
 }
 
-void ofxPixelBuffer::pushFront(const ofPixels& myPixels){
+template<typename T>
+bool ofxPixelBuffer_<T>::readRegion (int index, const ofRectangle& rect, ofPixels_<T>& out) const {
+    if (mySize == 0){
+        cout << "buffer is empty!\n";
+        out.clear();
+        return false;
+    }
+    int x, y, w, h;
+    if (!clipRegion(rect, myWidth, myHeight, x, y, w, h)){
+        cout << "region outside of frame!\n";
+        out.clear();
+        return false;
+    }
+    const T* src = read(index).getData();
+    if ((out.getWidth() != w)||(out.getHeight() != h)||(out.getNumChannels() != myChannels)){
+        out.allocate(w, h, myChannels);
+    }
+    T* dst = out.getData();
+    forEachRow(myWidth, myChannels, x, y, w, h, [&](size_t srcOffset, size_t dstOffset, size_t size){
+        memcpy(dst + dstOffset, src + srcOffset, size * sizeof(T));
+    });
+    OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, out.getTotalBytes());
+    return true;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::readLinearRegion (float index, const ofRectangle& rect, ofPixels_<T>& out) const {
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_READ_LINEAR);
+    if (mySize == 0){
+        cout << "buffer is empty!\n";
+        out.clear();
+        return;
+    }
+    int x, y, w, h;
+    if (!clipRegion(rect, myWidth, myHeight, x, y, w, h)){
+        cout << "region outside of frame!\n";
+        out.clear();
+        return;
+    }
+    // same frames and weight as readLinearInto
+    index = max(0.f, min(mySize-0.0001f, index));
+    int intPart = static_cast<int>(index);
+    float floatPart = index-intPart;
+    const T* pix1 = getFrame(intPart).getData();
+    const T* pix2 = getFrame((intPart+1)%mySize).getData();
+    if ((out.getWidth() != w)||(out.getHeight() != h)||(out.getNumChannels() != myChannels)){
+        out.allocate(w, h, myChannels);
+    }
+    T* dst = out.getData();
+    forEachRow(myWidth, myChannels, x, y, w, h, [&](size_t srcOffset, size_t dstOffset, size_t size){
+        myKernels->lerp(pix1 + srcOffset, pix2 + srcOffset, dst + dstOffset, size, floatPart);
+    });
+    OFX_PIXEL_BUFFER_COUNT_LERP(myCounters);
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::pushFrameFront(const ofPixels_<T>& myPixels){
+    // a slot of the slab or a recycled frame
+    myBuffer.push_front(newFrame());
+    memcpy(myBuffer.front().getData(), myPixels.getData(), myFrameSize);
+    OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+    mySize = myBuffer.size();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::pushFrameBack(const ofPixels_<T>& myPixels){
+    // a slot of the slab or a recycled frame
+    myBuffer.push_back(newFrame());
+    memcpy(myBuffer.back().getData(), myPixels.getData(), myFrameSize);
+    OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+    mySize = myBuffer.size();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::pushFront(const ofPixels_<T>& myPixels){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (bAllocated){
         if ((myPixels.getWidth() != myWidth)||(myPixels.getHeight() != myHeight)||(myPixels.getNumChannels() != myChannels)){
             cout << "wrong dimension!";
             return;
         }
 
-        myBuffer.push_front(myPixels);
-        mySize = myBuffer.size();
+        pushFrameFront(myPixels);
     }
     else {
         myWidth = myPixels.getWidth();
         myHeight = myPixels.getHeight();
         myChannels = myPixels.getNumChannels();
-        myFrameSize = myWidth*myHeight*myChannels;
+        myFrameSize = myWidth*myHeight*myChannels*sizeof(T);
         bAllocated = true;
-        myBuffer.push_front(myPixels);
-        mySize = myBuffer.size();
+        pushFrameFront(myPixels);
     }
 }
 
-void ofxPixelBuffer::pushFront(ofPixels&& myPixels){
+template<typename T>
+void ofxPixelBuffer_<T>::pushFront(ofPixels_<T>&& myPixels){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (bAllocated){
         if ((myPixels.getWidth() != myWidth)||(myPixels.getHeight() != myHeight)||(myPixels.getNumChannels() != myChannels)){
             cout << "wrong dimension!";
             return;
         }
 
-        myBuffer.push_front(move(myPixels));
-        mySize = myBuffer.size();
+        if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+            pushFrameFront(myPixels);
+        } else {
+            myBuffer.push_front(adoptFrame(move(myPixels)));
+            mySize = myBuffer.size();
+        }
     }
     else {
         myWidth = myPixels.getWidth();
         myHeight = myPixels.getHeight();
         myChannels = myPixels.getNumChannels();
-        myFrameSize = myWidth*myHeight*myChannels;
+        myFrameSize = myWidth*myHeight*myChannels*sizeof(T);
         bAllocated = true;
-        myBuffer.push_front(move(myPixels));
-        mySize = myBuffer.size();
+        if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+            pushFrameFront(myPixels);
+        } else {
+            myBuffer.push_front(adoptFrame(move(myPixels)));
+            mySize = myBuffer.size();
+        }
     }
 }
 
-ofPixels ofxPixelBuffer::popFront(){
+// a block nobody else shares can be handed out as it is.
+// shared frames, slab slots and mapped frames have to be copied.
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::takeFrame(ofPixels_<T>& frame){
+    auto it = myBlocks.find(frame.getData());
+    if (it != myBlocks.end() && !isShared(it->second)){
+        ofPixels_<T> pixels = move(*it->second.pixels);
+        myBlocks.erase(it);
+        frame.clear();
+        return pixels;
+    }
+    ofPixels_<T> copy = acquireFrame();
+    memcpy(copy.getData(), frame.getData(), myFrameSize);
+    OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+    releaseFrame(frame);
+    return copy;
+}
+
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::popFront(){
+    myVersion++;
+    if (!checkWritable()){
+        return ofPixels_<T>();
+    }
     if (!bAllocated){
         cout << "buffer not allocated!\n";
+        return ofPixels_<T>();
     }
     if (mySize == 0){
         cout << "buffer already empty!\n";
+        return ofPixels_<T>();
     }
 
-    ofPixels popPixels = myBuffer.front();
+    ofPixels_<T> popPixels = takeFrame(myBuffer.front());
     myBuffer.pop_front();
 
     mySize = myBuffer.size();
@@ -539,15 +1768,22 @@ ofPixels ofxPixelBuffer::popFront(){
     return popPixels;
 }
 
-ofPixels ofxPixelBuffer::popBack(){
+template<typename T>
+ofPixels_<T> ofxPixelBuffer_<T>::popBack(){
+    myVersion++;
+    if (!checkWritable()){
+        return ofPixels_<T>();
+    }
     if (!bAllocated){
         cout << "buffer not allocated!\n";
+        return ofPixels_<T>();
     }
     if (mySize == 0){
         cout << "buffer already empty!\n";
+        return ofPixels_<T>();
     }
 
-    ofPixels popPixels = myBuffer.back();
+    ofPixels_<T> popPixels = takeFrame(myBuffer.back());
     myBuffer.pop_back();
 
     mySize = myBuffer.size();
@@ -555,49 +1791,173 @@ ofPixels ofxPixelBuffer::popBack(){
     return popPixels;
 }
 
-void ofxPixelBuffer::pushBack(const ofPixels& myPixels){
+template<typename T>
+int ofxPixelBuffer_<T>::popFront(int numFrames, vector<ofPixels_<T>>& out){
+    myVersion++;
+    if (!checkWritable()){
+        return 0;
+    }
+    if (!bAllocated){
+        cout << "buffer not allocated!\n";
+        return 0;
+    }
+    numFrames = max(0, min(mySize, numFrames));
+    out.reserve(out.size() + numFrames);
+    for (int i = 0; i < numFrames; ++i){
+        out.push_back(takeFrame(myBuffer[i]));
+    }
+    myBuffer.erase(myBuffer.begin(), myBuffer.begin() + numFrames);
+    mySize = myBuffer.size();
+    return numFrames;
+}
+
+template<typename T>
+int ofxPixelBuffer_<T>::popBack(int numFrames, vector<ofPixels_<T>>& out){
+    myVersion++;
+    if (!checkWritable()){
+        return 0;
+    }
+    if (!bAllocated){
+        cout << "buffer not allocated!\n";
+        return 0;
+    }
+    numFrames = max(0, min(mySize, numFrames));
+    out.reserve(out.size() + numFrames);
+    for (int i = mySize - numFrames; i < mySize; ++i){
+        out.push_back(takeFrame(myBuffer[i]));
+    }
+    myBuffer.erase(myBuffer.end() - numFrames, myBuffer.end());
+    mySize = myBuffer.size();
+    return numFrames;
+}
+
+// validate a batch of frames once, adopting the dimensions of the first frame if not allocated yet
+template<typename T>
+bool ofxPixelBuffer_<T>::checkPush(const vector<ofPixels_<T>>& frames){
+    if (!checkWritable() || frames.empty()){
+        return false;
+    }
+    const ofPixels_<T>& first = frames.front();
+    int width = bAllocated ? myWidth : first.getWidth();
+    int height = bAllocated ? myHeight : first.getHeight();
+    int channels = bAllocated ? myChannels : first.getNumChannels();
+    for (auto& frame : frames){
+        if (((int)frame.getWidth() != width)||((int)frame.getHeight() != height)||((int)frame.getNumChannels() != channels)){
+            cout << "wrong dimension!";
+            return false;
+        }
+    }
+    if (!bAllocated){
+        myWidth = width;
+        myHeight = height;
+        myChannels = channels;
+        myFrameSize = myWidth*myHeight*myChannels*sizeof(T);
+        bAllocated = true;
+    }
+    // slab storage: grow only once
+    reserve(mySize + frames.size());
+    return true;
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::pushBack(const vector<ofPixels_<T>>& frames){
+    myVersion++;
+    if (!checkPush(frames)){
+        return;
+    }
+    for (auto& frame : frames){
+        myBuffer.push_back(newFrame());
+        memcpy(myBuffer.back().getData(), frame.getData(), myFrameSize);
+        OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+    }
+    mySize = myBuffer.size();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::pushBack(vector<ofPixels_<T>>&& frames){
+    myVersion++;
+    if (!checkPush(frames)){
+        return;
+    }
+    if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+        for (auto& frame : frames){
+            myBuffer.push_back(newFrame());
+            memcpy(myBuffer.back().getData(), frame.getData(), myFrameSize);
+            OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+        }
+    } else {
+        for (auto& frame : frames){
+            myBuffer.push_back(adoptFrame(move(frame)));
+        }
+    }
+    frames.clear();
+    mySize = myBuffer.size();
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::pushBack(const ofPixels_<T>& myPixels){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (bAllocated){
         if ((myPixels.getWidth() != myWidth)||(myPixels.getHeight() != myHeight)||(myPixels.getNumChannels() != myChannels)){
             cout << "wrong dimension!";
             return;
         }
 
-        myBuffer.push_back(myPixels);
-        mySize = myBuffer.size();
+        pushFrameBack(myPixels);
     }
     else {
         myWidth = myPixels.getWidth();
         myHeight = myPixels.getHeight();
         myChannels = myPixels.getNumChannels();
-        myFrameSize = myWidth*myHeight*myChannels;
+        myFrameSize = myWidth*myHeight*myChannels*sizeof(T);
         bAllocated = true;
-        myBuffer.push_back(myPixels);
-        mySize = myBuffer.size();
+        pushFrameBack(myPixels);
     }
 }
 
-void ofxPixelBuffer::pushBack(ofPixels&& myPixels){
+template<typename T>
+void ofxPixelBuffer_<T>::pushBack(ofPixels_<T>&& myPixels){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (bAllocated){
         if ((myPixels.getWidth() != myWidth)||(myPixels.getHeight() != myHeight)||(myPixels.getNumChannels() != myChannels)){
             cout << "wrong dimension!";
             return;
         }
 
-        myBuffer.push_back(move(myPixels));
-        mySize = myBuffer.size();
+        if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+            pushFrameBack(myPixels);
+        } else {
+            myBuffer.push_back(adoptFrame(move(myPixels)));
+            mySize = myBuffer.size();
+        }
     }
     else {
         myWidth = myPixels.getWidth();
         myHeight = myPixels.getHeight();
         myChannels = myPixels.getNumChannels();
-        myFrameSize = myWidth*myHeight*myChannels;
+        myFrameSize = myWidth*myHeight*myChannels*sizeof(T);
         bAllocated = true;
-        myBuffer.push_back(move(myPixels));
-        mySize = myBuffer.size();
+        if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+            pushFrameBack(myPixels);
+        } else {
+            myBuffer.push_back(adoptFrame(move(myPixels)));
+            mySize = myBuffer.size();
+        }
     }
 }
 
-void ofxPixelBuffer::replace(const ofxPixelBuffer& buffer, int index){
+template<typename T>
+void ofxPixelBuffer_<T>::replace(const ofxPixelBuffer_<T>& buffer, int index){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (!bAllocated){
         cout << "buffer not allocated!\n";
         return;
@@ -616,12 +1976,30 @@ void ofxPixelBuffer::replace(const ofxPixelBuffer& buffer, int index){
     int length = min(mySize - index, buffer.mySize);
 
     for (int i = 0; i < length; ++i){
-        myBuffer[i + index] = buffer.myBuffer[i];
+        if (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB){
+            memcpy(myBuffer[i + index].getData(), buffer.read(i).getData(), myFrameSize);
+            OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, myFrameSize);
+        } else {
+            // share before releasing, the frame might replace itself
+            ofPixels_<T> frame = shareFrame(buffer, i);
+            releaseFrame(myBuffer[i + index]);
+            myBuffer[i + index] = move(frame);
+        }
     }
 }
 
-// only makes sense if ofPixels has move assignment
-void ofxPixelBuffer::replace(ofxPixelBuffer&& buffer, int index){
+// sharing the frames is as cheap as moving them and leaves 'buffer' intact
+template<typename T>
+void ofxPixelBuffer_<T>::replace(ofxPixelBuffer_<T>&& buffer, int index){
+    replace(static_cast<const ofxPixelBuffer_<T>&>(buffer), index);
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::insert(const ofxPixelBuffer_<T>& buffer, int index){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (!bAllocated){
         cout << "buffer not allocated!\n";
         return;
@@ -637,14 +2015,28 @@ void ofxPixelBuffer::replace(ofxPixelBuffer&& buffer, int index){
     }
 
     index = max(0, min(mySize - 1, index));
-    int length = min(mySize - index, buffer.mySize);
-
-    for (int i = 0; i < length; ++i){
-        myBuffer[i + index] = move(buffer.myBuffer[i]);
+    // slab storage: grow the slab before creating any views
+    reserve(mySize + buffer.mySize);
+    vector<ofPixels_<T>> frames(buffer.mySize);
+    for (int i = 0; i < buffer.mySize; ++i){
+        frames[i] = shareFrame(buffer, i);
     }
+    myBuffer.insert(myBuffer.begin() + index, make_move_iterator(frames.begin()), make_move_iterator(frames.end()));
+    mySize = myBuffer.size();
+
+}
+
+template<typename T>
+void ofxPixelBuffer_<T>::insert(ofxPixelBuffer_<T>&& buffer, int index){
+    insert(static_cast<const ofxPixelBuffer_<T>&>(buffer), index);
 }
 
-void ofxPixelBuffer::insert(const ofxPixelBuffer& buffer, int index){
+template<typename T>
+void ofxPixelBuffer_<T>::remove(int index, int numFrames){
+    myVersion++;
+    if (!checkWritable()){
+        return;
+    }
     if (!bAllocated){
         cout << "buffer not allocated!\n";
         return;
@@ -654,211 +2046,646 @@ void ofxPixelBuffer::insert(const ofxPixelBuffer& buffer, int index){
         return;
     }
 
-    if ((buffer.myWidth != myWidth)||(buffer.myHeight != myHeight)||(buffer.myChannels != myChannels)){
-        cout << "wrong dimension!";
-        return;
+    index = max(0, min(mySize - 1, index));
+    int length;
+    // negative argument means 'till the end of buffer'
+    if (numFrames < 0){
+        length = mySize - index;
+    } else {
+        length = min(mySize - index, numFrames);
     }
 
-    index = max(0, min(mySize - 1, index));
-    myBuffer.insert(myBuffer.begin() + index, buffer.myBuffer.begin(), buffer.myBuffer.end());
+    for (int i = index; i < index + length; ++i){
+        releaseFrame(myBuffer[i]);
+    }
+    myBuffer.erase(myBuffer.begin() + index, myBuffer.begin() + index + length);
     mySize = myBuffer.size();
 
 }
 
-// only makes sense if ofPixels have move assignment
-void ofxPixelBuffer::insert(ofxPixelBuffer&& buffer, int index){
+template<typename T>
+ofxPixelBuffer_<T> ofxPixelBuffer_<T>::getCopy(int index, int numFrames){
     if (!bAllocated){
         cout << "buffer not allocated!\n";
-        return;
     }
     if (mySize == 0){
         cout << "buffer is empty!\n";
+    }
+
+    ofxPixelBuffer_<T> newBuffer;
+    newBuffer.myWidth = myWidth;
+    newBuffer.myHeight = myHeight;
+    newBuffer.myChannels = myChannels;
+    newBuffer.myFrameSize = myFrameSize;
+    // copies of mapped or streamed frames get their own memory
+    newBuffer.myStorage = (myStorage == OFX_PIXEL_BUFFER_STORAGE_SLAB) ? OFX_PIXEL_BUFFER_STORAGE_SLAB : OFX_PIXEL_BUFFER_STORAGE_FRAMES;
+    newBuffer.bAllocated = true;
+
+    index = max(0, min(mySize-1, index));
+    int length;
+    // negative argument means 'till the end of buffer'
+    if (numFrames < 0){
+        length = mySize - index;
+    } else {
+        length = min(mySize - index, numFrames);
+    }
+
+    newBuffer.reserve(length);
+    for (int i = 0; i < length; ++i){
+        newBuffer.myBuffer.push_back(newBuffer.shareFrame(*this, i + index));
+    }
+    newBuffer.mySize = length;
+
+    return newBuffer;
+
+}
+
+
+//-------------------------------------------------------------------------
+
+
+/// ofxPixelBufferRecorder
+
+template<typename T>
+void ofxPixelBufferRecorder_<T>::setBuffer(ofxPixelBuffer_<T>& buffer){
+    myBufferPtr = &buffer;
+    myCounter = 0;
+    bRecord = false;
+}
+
+
+template<typename T>
+void ofxPixelBufferRecorder_<T>::setDeltaEncoding(bool delta, int keyframeInterval, int tileSize){
+    if (myBufferPtr == nullptr){
+        cout << "\nset a buffer first!\n\n";
         return;
     }
+    myBufferPtr->setKeyframeInterval(keyframeInterval);
+    if (delta){
+        // a different tile size means encoding the frames again
+        if (myBufferPtr->isDeltaEncoded() && myBufferPtr->getDeltaTileSize() != tileSize){
+            myBufferPtr->setStorage(OFX_PIXEL_BUFFER_STORAGE_FRAMES);
+        }
+        myBufferPtr->setDeltaTileSize(tileSize);
+        myBufferPtr->setStorage(OFX_PIXEL_BUFFER_STORAGE_DELTA);
+    } else if (myBufferPtr->isDeltaEncoded()){
+        myBufferPtr->setStorage(OFX_PIXEL_BUFFER_STORAGE_FRAMES);
+    }
+}
 
-    if ((buffer.myWidth != myWidth)||(buffer.myHeight != myHeight)||(buffer.myChannels != myChannels)){
-        cout << "wrong dimension!";
+template<typename T>
+bool ofxPixelBufferRecorder_<T>::hasTarget() const {
+    if (myBufferPtr == nullptr && myWriter == nullptr){
+        cout << "\nset a buffer first!\n\n";
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+void ofxPixelBufferRecorder_<T>::record(int onset, int numFrames){
+    if (myBufferPtr == nullptr){
+        cout << "\nset a buffer first!\n\n";
+        return;
+    }
+    closeFile();
+
+    bRecord = true;
+    myOnset = onset;
+    myFrames = numFrames;
+    myCounter = 0;
+
+}
+
+template<typename T>
+void ofxPixelBufferRecorder_<T>::stop(){
+    if (!hasTarget()){
         return;
     }
 
-    index = max(0, min(mySize - 1, index));
-    myBuffer.insert(myBuffer.begin() + index, buffer.myBuffer.begin(), buffer.myBuffer.end());
-    mySize = myBuffer.size();
+    bRecord = false;
+}
+
+template<typename T>
+void ofxPixelBufferRecorder_<T>::resume(){
+    if (!hasTarget()){
+        return;
+    }
+
+    bRecord = true;
+}
+
+template<typename T>
+bool ofxPixelBufferRecorder_<T>::recordToFile(const string& filePath, int width, int height, int channels, int queueFrames){
+    closeFile();
+    auto writer = make_shared<ofxPixelBufferFileWriter_<T>>();
+    if (!writer->open(filePath, width, height, channels, queueFrames)){
+        return false;
+    }
+    myWriter = writer;
+    myAcquiredIndex = -1;
+    myCounter = 0;
+    bRecord = true;
+    return true;
+}
+
+template<typename T>
+bool ofxPixelBufferRecorder_<T>::closeFile(){
+    if (!myWriter){
+        return false;
+    }
+    bool success = myWriter->close();
+    myWriter.reset();
+    bRecord = false;
+    return success;
+}
+
+template<typename T>
+ofxPixelBufferWriterStats ofxPixelBufferRecorder_<T>::getFileStats() const {
+    return myWriter ? myWriter->getStats() : ofxPixelBufferWriterStats();
+}
+
+template<typename T>
+bool ofxPixelBufferRecorder_<T>::checkInput(const ofPixels_<T>& myPixels){
+    if (myBufferPtr == nullptr){
+        cout << "set a buffer first!\n\n";
+        return false;
+    }
+
+    if (bRecord){
+        if((myPixels.getWidth()!= myBufferPtr->getWidth()) ||
+            (myPixels.getHeight() != myBufferPtr->getHeight()) ||
+            (myPixels.getNumChannels() != myBufferPtr->getNumChannels())
+           ){
+            cout << "wrong dimensions!\n";
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// buffer index of the next frame or -1 if the recording is finished
+template<typename T>
+int ofxPixelBufferRecorder_<T>::nextIndex(){
+    int onset, length;
+
+    onset = max(0, min(myBufferPtr->size()-1, myOnset));
+
+    // if myFrames is negativ (e.g. -1) record till end of buffer
+    if (myFrames < 0){
+        length = myBufferPtr->size() - onset;
+    }
+    else {
+        length = max(1, min(myBufferPtr->size() - onset, myFrames));
+    }
+
+    if (myCounter >= length){
+        bRecord = false;
+        return -1;
+    }
 
+    return myCounter + onset;
 }
 
-void ofxPixelBuffer::remove(int index, int numFrames){
-    if (!bAllocated){
-        cout << "buffer not allocated!\n";
+template<typename T>
+void ofxPixelBufferRecorder_<T>::in(const ofPixels_<T>& myPixels){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_IN);
+    if (myWriter){
+        // dropped frames are counted by the writer
+        if (bRecord && myWriter->push(myPixels)){
+            myCounter++;
+        }
         return;
     }
-    if (mySize == 0){
-        cout << "buffer is empty!\n";
-        return;
+    if (checkInput(myPixels)){
+        int index = nextIndex();
+        if (index >= 0){
+            myBufferPtr->write(index, myPixels);
+            myCounter++;
+        }
     }
+}
 
-    index = max(0, min(mySize - 1, index));
-    int length;
-    // negative argument means 'till the end of buffer'
-    if (numFrames < 0){
-        length = mySize - index;
-    } else {
-        length = min(mySize - index, numFrames);
+template<typename T>
+void ofxPixelBufferRecorder_<T>::in(ofPixels_<T>&& myPixels){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_IN);
+    if (myWriter){
+        // the writer copies anyway
+        in(static_cast<const ofPixels_<T>&>(myPixels));
+        return;
+    }
+    if (checkInput(myPixels)){
+        int index = nextIndex();
+        if (index >= 0){
+            myBufferPtr->write(index, move(myPixels));
+            myCounter++;
+        }
     }
-
-    myBuffer.erase(myBuffer.begin() + index, myBuffer.begin() + index + numFrames);
-    mySize = myBuffer.size();
-
 }
 
-ofxPixelBuffer ofxPixelBuffer::getCopy(int index, int numFrames){
-    if (!bAllocated){
-        cout << "buffer not allocated!\n";
+template<typename T>
+ofPixels_<T>* ofxPixelBufferRecorder_<T>::acquireWriteSlot(){
+    if (!hasTarget()){
+        return nullptr;
     }
-    if (mySize == 0){
-        cout << "buffer is empty!\n";
+    if (!bRecord){
+        return nullptr;
     }
+    if (myWriter){
+        // pushed to the writer in commit()
+        if ((myScratch.getWidth() != myWriter->getWidth())||(myScratch.getHeight() != myWriter->getHeight())
+                ||(myScratch.getNumChannels() != myWriter->getNumChannels())){
+            myScratch.allocate(myWriter->getWidth(), myWriter->getHeight(), myWriter->getNumChannels());
+        }
+        myAcquiredIndex = myCounter;
+        return &myScratch;
+    }
+    myAcquiredIndex = nextIndex();
+    if (myAcquiredIndex < 0){
+        return nullptr;
+    }
+    if (myBufferPtr->isCompressed() || myBufferPtr->isDeltaEncoded()){
+        // the frame is encoded in commit()
+        if ((myScratch.getWidth() != myBufferPtr->getWidth())||(myScratch.getHeight() != myBufferPtr->getHeight())
+                ||(myScratch.getNumChannels() != myBufferPtr->getNumChannels())){
+            myScratch.allocate(myBufferPtr->getWidth(), myBufferPtr->getHeight(), myBufferPtr->getNumChannels());
+        }
+        return &myScratch;
+    }
+    return &myBufferPtr->getWritable(myAcquiredIndex);
+}
 
-    ofxPixelBuffer newBuffer;
-    newBuffer.myWidth = myWidth;
-    newBuffer.myHeight = myHeight;
-    newBuffer.myChannels = myChannels;
-    newBuffer.myFrameSize = myFrameSize;
-    newBuffer.bAllocated = true;
-
-    index = max(0, min(mySize-1, index));
-    int length;
-    // negative argument means 'till the end of buffer'
-    if (numFrames < 0){
-        length = mySize - index;
+template<typename T>
+void ofxPixelBufferRecorder_<T>::commit(){
+    if (myAcquiredIndex < 0){
+        cout << "acquire a write slot first!\n";
+        return;
+    }
+    if (myWriter){
+        myAcquiredIndex = -1;
+        if (myWriter->push(myScratch)){
+            myCounter++;
+        }
+        return;
+    }
+    if (myBufferPtr->isCompressed() || myBufferPtr->isDeltaEncoded()){
+        myBufferPtr->write(myAcquiredIndex, myScratch);
     } else {
-        length = min(mySize - index, numFrames);
+        // the frame has been written since getWritable()
+        myBufferPtr->touch();
     }
+    myAcquiredIndex = -1;
+    myCounter++;
+}
 
-    newBuffer.myBuffer.resize(length);
-    newBuffer.mySize = length;
+//----------------------------------------------------------------------------
 
-    for (int i = 0; i < length; ++i){
-        newBuffer.myBuffer[i] = myBuffer[i + index];
-    }
+/// ofxPixelRingBuffer
 
-    return newBuffer;
+template<typename T>
+ofxPixelRingBuffer_<T>::ofxPixelRingBuffer_(){
+    myIndex = 0;
+    bConcurrent = false;
+    for (auto& slot : myReadSlots){
+        slot = -1;
+    }
+    myDroppedFrames = 0;
+    bAcquired = false;
+}
 
+template<typename T>
+ofxPixelRingBuffer_<T>::ofxPixelRingBuffer_(int width, int height, int channels, int frames)
+    : ofxPixelRingBuffer_<T>() {
+    allocate(width, height, channels, frames);
 }
 
+template<typename T>
+ofxPixelRingBuffer_<T>::ofxPixelRingBuffer_(const ofxPixelRingBuffer_<T>& mom)
+    : ofxPixelRingBuffer_<T>() {
+    *this = mom;
+}
 
-//-------------------------------------------------------------------------
+template<typename T>
+ofxPixelRingBuffer_<T>& ofxPixelRingBuffer_<T>::operator= (const ofxPixelRingBuffer_<T>& mom){
+    if (&mom != this){
+        myBuffer = mom.myBuffer;
+        myIndex = mom.myIndex.load();
+        bConcurrent = mom.bConcurrent;
+        myDroppedFrames = 0;
+    }
+    return *this;
+}
 
+template<typename T>
+void ofxPixelRingBuffer_<T>::allocate(int width, int height, int channels, int frames){
+    myBuffer.allocate(width, height, channels, frames + (bConcurrent ? 1 : 0));
+    myIndex = 0;
+}
 
-/// ofxPixelBufferRecorder
+template<typename T>
+void ofxPixelRingBuffer_<T>::setConcurrent(bool concurrent){
+    if (concurrent != bConcurrent){
+        bConcurrent = concurrent;
+        // add or remove the reserve slot
+        if (myBuffer.isAllocated()){
+            myBuffer.resize(myBuffer.size() + (concurrent ? 1 : -1));
+            myIndex = 0;
+        }
+    }
+}
 
-void ofxPixelBufferRecorder::setBuffer(ofxPixelBuffer& buffer){
-    myBufferPtr = &buffer;
-    myCounter = 0;
-    bRecord = false;
+template<typename T>
+void ofxPixelRingBuffer_<T>::resize(int size){
+    myBuffer.resize(size + (bConcurrent ? 1 : 0));
+    if (myIndex >= myBuffer.size()){
+        myIndex = 0;
+    }
 }
 
+template<typename T>
+int ofxPixelRingBuffer_<T>::size() const {
+    return max(0, myBuffer.size() - (bConcurrent ? 1 : 0));
+}
 
-void ofxPixelBufferRecorder::record(int onset, int numFrames){
-    if (myBufferPtr == nullptr){
-        cout << "\nset a buffer first!\n\n";
-        return;
+// false if the frame has to be dropped
+template<typename T>
+bool ofxPixelRingBuffer_<T>::canWrite(int index){
+    if (bConcurrent){
+        // the consumer is copying from the slot we would overwrite. don't wait, drop the frame.
+        // (seq_cst pairs with the store + load in acquireReadSlot)
+        for (auto& slot : myReadSlots){
+            if (slot.load() == index){
+                myDroppedFrames++;
+                return false;
+            }
+        }
     }
+    return true;
+}
 
-    bRecord = true;
-    myOnset = onset;
-    myFrames = numFrames;
-    myCounter = 0;
+template<typename T>
+void ofxPixelRingBuffer_<T>::publish(int index){
+    index--;
+    if(index < 0){
+        index = myBuffer.size() - 1;
+    }
+    myIndex.store(index);
+}
 
+template<typename T>
+void ofxPixelRingBuffer_<T>::in(const ofPixels_<T>& myPixels){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_IN);
+    // only the producer changes myIndex
+    int index = myIndex.load(memory_order_relaxed);
+    if (canWrite(index)){
+        myBuffer.write(index, myPixels);
+        publish(index);
+    }
 }
 
-void ofxPixelBufferRecorder::stop(){
-    if (myBufferPtr == nullptr){
-        cout << "\nset a buffer first!\n\n";
-        return;
+template<typename T>
+void ofxPixelRingBuffer_<T>::in(ofPixels_<T>&& myPixels){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_IN);
+    int index = myIndex.load(memory_order_relaxed);
+    if (canWrite(index)){
+        myBuffer.write(index, move(myPixels));
+        publish(index);
     }
+}
 
-    bRecord = false;
+template<typename T>
+ofPixels_<T>* ofxPixelRingBuffer_<T>::acquireWriteSlot(){
+    if (myBuffer.size() == 0){
+        cout << "buffer has no frames!\n";
+        return nullptr;
+    }
+    int index = myIndex.load(memory_order_relaxed);
+    if (!canWrite(index)){
+        return nullptr;
+    }
+    bAcquired = true;
+    return &myBuffer.getWritable(index);
 }
 
-void ofxPixelBufferRecorder::resume(){
-    if (myBufferPtr == nullptr){
-        cout << "\nset a buffer first!\n\n";
+template<typename T>
+void ofxPixelRingBuffer_<T>::commit(){
+    if (!bAcquired){
+        cout << "acquire a write slot first!\n";
         return;
     }
+    bAcquired = false;
+    // the frame has been written since getWritable()
+    myBuffer.touch();
+    publish(myIndex.load(memory_order_relaxed));
+}
 
-    bRecord = true;
+// concurrent mode: announce the slot of 'index' to the producer before reading from it.
+// if the producer has moved on to that very slot in the meantime, try again.
+template<typename T>
+int ofxPixelRingBuffer_<T>::acquireReadSlot(int index) const {
+    int length = myBuffer.size();
+    while (true){
+        int slot = (index + myIndex.load() + 1) % length;
+        myReadSlots[0].store(slot);
+        if (myIndex.load() != slot){
+            return slot;
+        }
+    }
 }
 
-void ofxPixelBufferRecorder::in(const ofPixels& myPixels){
-    if (myBufferPtr == nullptr){
-        cout << "set a buffer first!\n\n";
+// same for several frames at once. in non-concurrent mode the slots are only looked up.
+template<typename T>
+void ofxPixelRingBuffer_<T>::blendSlots(const int* frames, int count, float weight, const ofRectangle& rect, ofPixels_<T>& out) const {
+    int x, y, w, h;
+    if (!clipRegion(rect, getWidth(), getHeight(), x, y, w, h)){
+        cout << "region outside of frame!\n";
+        out.clear();
         return;
     }
-
-    if (bRecord){
-
-        if((myPixels.getWidth()!= myBufferPtr->getWidth()) ||
-            (myPixels.getHeight() != myBufferPtr->getHeight()) ||
-            (myPixels.getNumChannels() != myBufferPtr->getNumChannels())
-           ){
-            cout << "wrong dimensions!\n";
-            return;
+    int length = myBuffer.size();
+    int slots[numReadSlots];
+    while (true){
+        int writeIndex = myIndex.load();
+        for (int i = 0; i < count; ++i){
+            slots[i] = (frames[i] + writeIndex + 1) % length;
         }
-
-        int onset, length;
-
-        onset = max(0, min(myBufferPtr->size()-1, myOnset));
-
-        // if myFrames is negativ (e.g. -1) record till end of buffer
-        if (myFrames < 0){
-            length = myBufferPtr->size() - onset;
+        if (!bConcurrent){
+            break;
         }
-        else {
-            length = max(1, min(myBufferPtr->size() - onset, myFrames));
+        for (int i = 0; i < count; ++i){
+            myReadSlots[i].store(slots[i]);
         }
-
-        if (myCounter >= length){
-            bRecord = false;
-            return;
+        writeIndex = myIndex.load();
+        bool free = true;
+        for (int i = 0; i < count; ++i){
+            free = free && (slots[i] != writeIndex);
+        }
+        if (free){
+            break;
+        }
+    }
+    if ((out.getWidth() != w)||(out.getHeight() != h)||(out.getNumChannels() != getNumChannels())){
+        out.allocate(w, h, getNumChannels());
+    }
+    const T* pix[numReadSlots];
+    for (int i = 0; i < count; ++i){
+        pix[i] = myBuffer.read(slots[i]).getData();
+    }
+    T* dst = out.getData();
+    forEachRow(getWidth(), getNumChannels(), x, y, w, h, [&](size_t srcOffset, size_t dstOffset, size_t size){
+        if (count == 2){
+            myBuffer.myKernels->lerp(pix[0] + srcOffset, pix[1] + srcOffset, dst + dstOffset, size, weight);
+        } else {
+            myBuffer.myKernels->cubic(pix[0] + srcOffset, pix[1] + srcOffset, pix[2] + srcOffset, pix[3] + srcOffset,
+                                      dst + dstOffset, size, weight);
         }
+    });
+    OFX_PIXEL_BUFFER_COUNT_LERP(myCounters);
+    if (bConcurrent){
+        releaseReadSlots();
+    }
+}
 
-        myBufferPtr->write(myCounter + onset, myPixels);
+template<typename T>
+void ofxPixelRingBuffer_<T>::releaseReadSlots() const {
+    for (auto& slot : myReadSlots){
+        slot.store(-1);
+    }
+}
 
-        myCounter++;
+template<typename T>
+const ofPixels_<T>& ofxPixelRingBuffer_<T>::read(int index) const{
+    int length = myBuffer.size();
+    // limit index
+    index = max(0, min(size() - 1, index));
+    // add 1 to compensate for decrementing the myIndex in ofxPixelRingBuffer::in()
+    return myBuffer.read((index + myIndex.load(memory_order_acquire) + 1) % length);
+}
 
+template<typename T>
+bool ofxPixelRingBuffer_<T>::readInto(int index, ofPixels_<T>& out) const{
+    if (size() == 0){
+        cout << "buffer is empty!\n";
+        return false;
+    }
+    // limit index
+    index = max(0, min(size() - 1, index));
+    const ofPixels_<T>* frame;
+    if (bConcurrent){
+        frame = &myBuffer.read(acquireReadSlot(index));
+    } else {
+        frame = &read(index);
+    }
+    if ((out.getWidth() != frame->getWidth())||(out.getHeight() != frame->getHeight())||(out.getNumChannels() != frame->getNumChannels())){
+        out.allocate(frame->getWidth(), frame->getHeight(), frame->getNumChannels());
     }
+    memcpy(out.getData(), frame->getData(), frame->getTotalBytes());
+    OFX_PIXEL_BUFFER_COUNT_BYTES(myCounters, frame->getTotalBytes());
+    if (bConcurrent){
+        myReadSlots[0].store(-1);
+    }
+    return true;
+}
 
+template<typename T>
+ofPixels_<T> ofxPixelRingBuffer_<T>::readLinear(float index) const{
+    ofPixels_<T> temp;
+    readLinearInto(index, temp);
+    return temp;
 }
 
-//----------------------------------------------------------------------------
+template<typename T>
+void ofxPixelRingBuffer_<T>::readLinearInto(float index, ofPixels_<T>& out) const{
+    float length = static_cast<float>(myBuffer.size());
+    // limit index
+    index = max(0.f, min(size() - 1.f, index));
+    if (bConcurrent && size() > 0){
+        // otherwise the underlying buffer takes the time
+        OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_READ_LINEAR);
+        // blend directly: slot1 + fraction could round up to the next slot
+        int intPart = static_cast<int>(index);
+        int frames[2] = {intPart, min(intPart + 1, size() - 1)};
+        blendSlots(frames, 2, index - intPart, ofRectangle(0, 0, getWidth(), getHeight()), out);
+        return;
+    }
+    // add 1 to compensate for decrementing the myIndex in ofxPixelRingBuffer::in()
+    float k = index + myIndex.load(memory_order_acquire) + 1.f;
+    k = fmodf(k, length);
+    myBuffer.readLinearInto(k, out);
+}
 
-/// ofxPixelRingBuffer
 
-void ofxPixelRingBuffer::in(const ofPixels& myPixels){
-    myBuffer.write(myIndex, myPixels);
-    myIndex--;
-    if(myIndex < 0){
-        myIndex = myBuffer.size() - 1;
+template<typename T>
+ofPixels_<T> ofxPixelRingBuffer_<T>::readCubic(float index) const{
+    ofPixels_<T> temp;
+    readCubicInto(index, temp);
+    return temp;
+}
+
+template<typename T>
+void ofxPixelRingBuffer_<T>::readCubicInto(float index, ofPixels_<T>& out) const{
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_READ_CUBIC);
+    if (size() == 0){
+        cout << "buffer is empty!\n";
+        out.clear();
+        return;
     }
+    index = max(0.f, min(size() - 1.f, index));
+    int intPart = static_cast<int>(index);
+    int frames[4];
+    for (int i = 0; i < 4; ++i){
+        frames[i] = max(0, min(size() - 1, intPart - 1 + i));
+    }
+    blendSlots(frames, 4, index - intPart, ofRectangle(0, 0, getWidth(), getHeight()), out);
 }
 
-const ofPixels& ofxPixelRingBuffer::read(int index) const{
-    int length = myBuffer.size();
+template<typename T>
+bool ofxPixelRingBuffer_<T>::readRegion(int index, const ofRectangle& rect, ofPixels_<T>& out) const{
+    if (size() == 0){
+        cout << "buffer is empty!\n";
+        out.clear();
+        return false;
+    }
     // limit index
-    index = max(0, min(length - 1, index));
-    // add 1 to compensate for decrementing the myIndex in ofxPixelRingBuffer::in()
-    return myBuffer.read((index + myIndex + 1) % length);
+    index = max(0, min(size() - 1, index));
+    if (!bConcurrent){
+        // add 1 to compensate for decrementing the myIndex in ofxPixelRingBuffer::in()
+        return myBuffer.readRegion((index + myIndex.load(memory_order_acquire) + 1) % myBuffer.size(), rect, out);
+    }
+    bool success = myBuffer.readRegion(acquireReadSlot(index), rect, out);
+    myReadSlots[0].store(-1);
+    return success;
 }
 
-ofPixels ofxPixelRingBuffer::readLinear(float index) const{
+template<typename T>
+void ofxPixelRingBuffer_<T>::readLinearRegion(float index, const ofRectangle& rect, ofPixels_<T>& out) const{
     float length = static_cast<float>(myBuffer.size());
     // limit index
-    index = max(0.f, min(myBuffer.size() - 1.f, index));
-    // add 1 to compensate for decrementing the myIndex in ofxPixelRingBuffer::in()
-    float k = index + myIndex + 1.f;
+    index = max(0.f, min(size() - 1.f, index));
+    if (bConcurrent && size() > 0){
+        OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_READ_LINEAR);
+        int intPart = static_cast<int>(index);
+        int frames[2] = {intPart, min(intPart + 1, size() - 1)};
+        blendSlots(frames, 2, index - intPart, rect, out);
+        return;
+    }
+    float k = index + myIndex.load(memory_order_acquire) + 1.f;
     k = fmodf(k, length);
-    return myBuffer.readLinear(k);
+    myBuffer.readLinearRegion(k, rect, out);
+}
+
+template<typename T>
+ofxPixelBufferStats ofxPixelRingBuffer_<T>::getStats() const{
+    ofxPixelBufferStats stats = myCounters.getStats();
+    stats += myBuffer.getStats();
+    return stats;
+}
+
+template<typename T>
+void ofxPixelRingBuffer_<T>::resetStats(){
+    myCounters.reset();
+    myBuffer.resetStats();
 }
 
 
@@ -866,13 +2693,14 @@ ofPixels ofxPixelRingBuffer::readLinear(float index) const{
 
 /// ofxPixelBufferPlayer
 
-ofxPixelBufferPlayer::ofxPixelBufferPlayer() {
+template<typename T>
+ofxPixelBufferPlayer_<T>::ofxPixelBufferPlayer_() {
     myBufferPtr = nullptr;
     bPlay = false;
     bLoop = false;
     bLoopNew = false;
     bPingPong = false;
-    bLerp = false;
+    myInterpolation = OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST;
     myFrameRate = 30;
     myPosition = 0;
     myTime = 0;
@@ -885,15 +2713,17 @@ ofxPixelBufferPlayer::ofxPixelBufferPlayer() {
     size = myLoopSize;
     myLoopOnsetDev = 0;
     myLoopSizeDev = 0;
+    mySourceFrame = -1;
 }
 
-ofxPixelBufferPlayer::ofxPixelBufferPlayer(ofxPixelBuffer& buffer) {
+template<typename T>
+ofxPixelBufferPlayer_<T>::ofxPixelBufferPlayer_(ofxPixelBuffer_<T>& buffer) {
     myBufferPtr = &buffer;
     bPlay = false;
     bLoop = false;
     bLoopNew = false;
     bPingPong = false;
-    bLerp = false;
+    myInterpolation = OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST;
     myFrameRate = 30;
     myPosition = 0;
     myTime = 0;
@@ -905,34 +2735,86 @@ ofxPixelBufferPlayer::ofxPixelBufferPlayer(ofxPixelBuffer& buffer) {
     size = myLoopSize;
     myLoopOnsetDev = 0;
     myLoopSizeDev = 0;
-
+    mySourceFrame = -1;
 }
 
-void ofxPixelBufferPlayer::setBuffer(ofxPixelBuffer& buffer) {
+template<typename T>
+void ofxPixelBufferPlayer_<T>::setBuffer(ofxPixelBuffer_<T>& buffer) {
     myBufferPtr = &buffer;
+    mySourceFrame = -1;
 }
 
-bool ofxPixelBufferPlayer::hasBuffer() const {
+template<typename T>
+bool ofxPixelBufferPlayer_<T>::hasBuffer() const {
     return (myBufferPtr != nullptr);
 }
 
-void ofxPixelBufferPlayer::update(){
+template<typename T>
+void ofxPixelBufferPlayer_<T>::update(){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_UPDATE);
+    if (advance()){
+        interpolate();
+    }
+}
+
+template<typename T>
+void ofxPixelBufferPlayer_<T>::update(double dt){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_UPDATE);
+    if (advance(dt)){
+        interpolate();
+    }
+}
+
+template<typename T>
+bool ofxPixelBufferPlayer_<T>::checkBuffer() const {
     if (myBufferPtr == nullptr){
         cout << "set buffer first!";
-        return;
+        return false;
     }
 
     if (!myBufferPtr->isAllocated()){
         cout << "buffer not allocated!\n";
-        return;
+        return false;
     }
+    return true;
+}
 
-    float length = myBufferPtr->size() - 1.f;
+template<typename T>
+int64_t ofxPixelBufferPlayer_<T>::now() const {
+    return myClock ? myClock() : ofGetElapsedTimeMicros();
+}
 
+template<typename T>
+bool ofxPixelBufferPlayer_<T>::advance(){
+    if (!checkBuffer()){
+        return false;
+    }
+    float delta = 0;
     if (bPlay){
-        int64_t newTime = ofGetElapsedTimeMicros();
-        float delta = (newTime - oldTime)/1000000.f;
+        int64_t newTime = now();
+        delta = (newTime - oldTime)/1000000.f;
         oldTime = newTime;
+    }
+    return step(delta);
+}
+
+template<typename T>
+bool ofxPixelBufferPlayer_<T>::advance(double dt){
+    if (!checkBuffer()){
+        return false;
+    }
+    if (bPlay){
+        // so that update() continues from here
+        oldTime = now();
+    }
+    return step(dt);
+}
+
+template<typename T>
+bool ofxPixelBufferPlayer_<T>::step(float delta){
+    float length = myBufferPtr->size() - 1.f;
+
+    if (bPlay){
         myTime += delta;
 
         if (bLoop){
@@ -1013,27 +2895,179 @@ void ofxPixelBufferPlayer::update(){
         }
         // check for boundaries
         myPosition = max(0.f, min(length, myPosition));
-        // update lerpPixels if linear interpolation is turned on
-        if (bLerp){
-            // ofxPixelBuffer::readLinear() calculates the interpolated pixels
-            lerpPixels = myBufferPtr->readLinear(myPosition);
+        // streamed buffers: load the frames we are going to need next
+        if (myBufferPtr->isStreamed()){
+            requestPrefetch(delta);
         }
+        // update lerpPixels if interpolation is turned on
+        return myInterpolation != OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST;
     } else {
         // only check for boundaries:
         myPosition = max(0.f, min(length, myPosition));
+        return false;
+    }
+}
+
+
+// predict the frames of the next updates (following the loop and ping pong logic of update())
+// and ask the buffer to prefetch them.
+template<typename T>
+void ofxPixelBufferPlayer_<T>::requestPrefetch(float delta){
+    int depth = myBufferPtr->getPrefetchDepth();
+    float length = myBufferPtr->size() - 1.f;
+    // frames per update, but at least one frame, so we look at every frame when playing slowly
+    float step = max(1.f, fabsf(delta * mySpeed * myFrameRate));
+    float direction = (mySpeed * (bLoop ? myDirection : 1) >= 0) ? 1.f : -1.f;
+    float loopStart = bLoop ? onset : 0.f;
+    float loopEnd = bLoop ? onset + size : length;
+
+    auto addFrame = [&](int frame){
+        if (frame >= 0 && frame <= length
+                && find(myPrefetchFrames.begin(), myPrefetchFrames.end(), frame) == myPrefetchFrames.end()){
+            myPrefetchFrames.push_back(frame);
+        }
+    };
+
+    myPrefetchFrames.clear();
+    float position = myPosition;
+    // most urgent first: the current frame(s)
+    addFrame(static_cast<int>(position));
+    addFrame(static_cast<int>(position) + 1);
+    for (int i = 0; i < depth * 4 && static_cast<int>(myPrefetchFrames.size()) < depth; ++i){
+        position += step * direction;
+        if (position > loopEnd){
+            if (!bLoop){
+                break;
+            }
+            if (bPingPong){
+                position = loopEnd;
+                direction *= -1.f;
+            } else {
+                position = loopStart;
+            }
+        } else if (position < loopStart){
+            if (!bLoop){
+                break;
+            }
+            if (bPingPong){
+                position = loopStart;
+                direction *= -1.f;
+            } else {
+                position = loopEnd;
+            }
+        }
+        if (myInterpolation == OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC){
+            // cubic interpolation needs two neighbours on each side
+            addFrame(static_cast<int>(position) - 1);
+            addFrame(static_cast<int>(position));
+            addFrame(static_cast<int>(position) + 1);
+            addFrame(static_cast<int>(position) + 2);
+        } else if (myInterpolation == OFX_PIXEL_BUFFER_INTERPOLATION_LINEAR){
+            // interpolation needs both neighbours
+            addFrame(static_cast<int>(position));
+            addFrame(static_cast<int>(position) + 1);
+        } else {
+            addFrame(static_cast<int>(position + 0.5f));
+        }
+    }
+    myBufferPtr->prefetch(myPrefetchFrames);
+}
+
+
+// splits the position like ofxPixelBuffer::readLinearInto / readCubicInto
+template<typename T>
+void ofxPixelBufferPlayer_<T>::splitPosition(float position, int& frame, float& weight) const {
+    int length = myBufferPtr->size();
+    if (length == 0){
+        frame = 0;
+        weight = 0;
+        return;
+    }
+    float index = max(0.f, min(length - 0.0001f, position));
+    frame = static_cast<int>(index);
+    weight = index - frame;
+    if (myInterpolation != OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC){
+        // round like the lerp kernel does, so positions which blend the same share the result
+        int steps = myBufferPtr->myKernels->lerpSteps;
+        if (steps > 0){
+            weight = static_cast<int>(weight * steps + 0.5f) / static_cast<float>(steps);
+        }
     }
+}
 
+template<typename T>
+typename ofxPixelBufferPlayer_<T>::BlendKey ofxPixelBufferPlayer_<T>::getBlendKey(float position) const {
+    BlendKey key;
+    key.buffer = myBufferPtr;
+    key.version = myBufferPtr->getVersion();
+    key.mode = myInterpolation;
+    splitPosition(position, key.frame, key.weight);
+    return key;
+}
+
+template<typename T>
+int ofxPixelBufferPlayer_<T>::findSourceFrame(int& frame, float& weight) const {
+    int length = myBufferPtr->size();
+    splitPosition(myPosition, frame, weight);
+    if (length == 0){
+        return -1;
+    }
+    int next = (frame + 1) % length;
+    if (myInterpolation == OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC){
+        int prev = (frame + length - 1) % length;
+        int next2 = (frame + 2) % length;
+        if (weight == 0.f || (myBufferPtr->isSameFrame(prev, frame) && myBufferPtr->isSameFrame(frame, next)
+                              && myBufferPtr->isSameFrame(next, next2))){
+            return frame;
+        }
+        return -1;
+    }
+    if (weight <= 0.f || myBufferPtr->isSameFrame(frame, next)){
+        return frame;
+    }
+    if (weight >= 1.f){
+        return next;
+    }
+    return -1;
+}
 
+template<typename T>
+void ofxPixelBufferPlayer_<T>::interpolate(){
+    mySharedPixels.reset();
+    int frame;
+    float weight;
+    mySourceFrame = findSourceFrame(frame, weight);
+    if (mySourceFrame >= 0){
+        // integer position (or identical frames): nothing to blend
+        return;
+    }
+    BlendKey key = getBlendKey(myPosition);
+    // frames which are still being loaded change without a new version
+    if (key == myBlendKey && lerpPixels.isAllocated() && !myBufferPtr->isLoading()){
+        return;
+    }
+    // both blend into lerpPixels without reallocating
+    if (myInterpolation == OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC){
+        myBufferPtr->readCubicInto(myPosition, lerpPixels);
+    } else {
+        myBufferPtr->readLinearInto(myPosition, lerpPixels);
+    }
+    myBlendKey = key;
 }
 
 
-const ofPixels& ofxPixelBufferPlayer::getPixels() const {
+template<typename T>
+const ofPixels_<T>& ofxPixelBufferPlayer_<T>::getPixels() const {
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return dummy;
     }
 
-    if (bLerp && lerpPixels.isAllocated()){
+    if (myInterpolation != OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST && mySharedPixels){
+        return *mySharedPixels;
+    } else if (myInterpolation != OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST && mySourceFrame >= 0){
+        return myBufferPtr->read(mySourceFrame);
+    } else if (myInterpolation != OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST && lerpPixels.isAllocated()){
         return lerpPixels;
     } else {
         return myBufferPtr->read(static_cast<int>(myPosition + 0.5f)); // round to frame
@@ -1041,14 +3075,15 @@ const ofPixels& ofxPixelBufferPlayer::getPixels() const {
 }
 
 
-void ofxPixelBufferPlayer::play(float frameOnset){
+template<typename T>
+void ofxPixelBufferPlayer_<T>::play(float frameOnset){
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return;
     }
 
     myPosition = frameOnset;
-    oldTime = ofGetElapsedTimeMicros();
+    oldTime = now();
     myTime = 0;
     // necessary so that jumping out of a ping pong loop works as expected
     myDirection = 1;
@@ -1056,7 +3091,23 @@ void ofxPixelBufferPlayer::play(float frameOnset){
 
 }
 
-void ofxPixelBufferPlayer::resetLoop(){
+template<typename T>
+void ofxPixelBufferPlayer_<T>::resume(){
+    bPlay = true;
+    oldTime = now();
+}
+
+template<typename T>
+void ofxPixelBufferPlayer_<T>::setClock(function<int64_t()> clock){
+    myClock = clock;
+    if (bPlay){
+        // the new clock might count from somewhere else
+        oldTime = now();
+    }
+}
+
+template<typename T>
+void ofxPixelBufferPlayer_<T>::resetLoop(){
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return;
@@ -1084,23 +3135,25 @@ void ofxPixelBufferPlayer::resetLoop(){
             myPosition = onset + size;
         }
 
-        if (!bPlay && bLerp){
+        if (!bPlay && myInterpolation != OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST){
             // here we should check
             myPosition = max(0.f, min(length, myPosition));
-            lerpPixels = myBufferPtr->readLinear(myPosition);
+            interpolate();
         }
     }
 
 }
 
-void ofxPixelBufferPlayer::setLoopPingPong(bool mode){
+template<typename T>
+void ofxPixelBufferPlayer_<T>::setLoopPingPong(bool mode){
     if (bPingPong != mode){
         bPingPong = mode;
         myDirection = 1;
     }
 }
 
-float ofxPixelBufferPlayer::getLoopSize() const {
+template<typename T>
+float ofxPixelBufferPlayer_<T>::getLoopSize() const {
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return 0;
@@ -1109,7 +3162,8 @@ float ofxPixelBufferPlayer::getLoopSize() const {
     return max(0.f, min(myBufferPtr->size() - 1.f - myLoopOnset, myLoopSize));
 }
 
-int ofxPixelBufferPlayer::getTotalNumFrames() const {
+template<typename T>
+int ofxPixelBufferPlayer_<T>::getTotalNumFrames() const {
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return 0;
@@ -1118,7 +3172,8 @@ int ofxPixelBufferPlayer::getTotalNumFrames() const {
     return myBufferPtr->size();
 }
 
-float ofxPixelBufferPlayer::getTotalDuration() const {
+template<typename T>
+float ofxPixelBufferPlayer_<T>::getTotalDuration() const {
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return 0;
@@ -1127,7 +3182,8 @@ float ofxPixelBufferPlayer::getTotalDuration() const {
     return myBufferPtr->size()/myFrameRate;
 }
 
-void ofxPixelBufferPlayer::setFrameRate(float fps) {
+template<typename T>
+void ofxPixelBufferPlayer_<T>::setFrameRate(float fps) {
     if (fps > 0) {
         myFrameRate = fps;
     } else {
@@ -1135,18 +3191,19 @@ void ofxPixelBufferPlayer::setFrameRate(float fps) {
     }
 }
 
-void ofxPixelBufferPlayer::setPosition(float frames){
+template<typename T>
+void ofxPixelBufferPlayer_<T>::setPosition(float frames){
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return;
     }
 
-    if (!bPlay && bLerp){
+    if (!bPlay && myInterpolation != OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST){
         // check for boundaries
         float length = myBufferPtr->size()-1.f;
         myPosition = max(0.f, min(length, frames));
         // update lerpPixels
-        lerpPixels = myBufferPtr->readLinear(myPosition);
+        interpolate();
     } else {
         // checking is not necessary
         myPosition = frames;
@@ -1155,7 +3212,8 @@ void ofxPixelBufferPlayer::setPosition(float frames){
     myDirection = 1;
 }
 
-float ofxPixelBufferPlayer::getPosition() const {
+template<typename T>
+float ofxPixelBufferPlayer_<T>::getPosition() const {
     if (myBufferPtr == nullptr){
         cout << "set buffer first!\n";
         return 0;
@@ -1164,11 +3222,13 @@ float ofxPixelBufferPlayer::getPosition() const {
     return max(0.f, min(myBufferPtr->size() - 1.f, myPosition));
 }
 
-void ofxPixelBufferPlayer::setRelativePosition(float position){
+template<typename T>
+void ofxPixelBufferPlayer_<T>::setRelativePosition(float position){
     setPosition(position * getTotalNumFrames());
 }
 
-bool ofxPixelBufferPlayer::isAllocated() const {
+template<typename T>
+bool ofxPixelBufferPlayer_<T>::isAllocated() const {
     if (myBufferPtr != nullptr){
         return myBufferPtr->isAllocated();
     } else {
@@ -1176,7 +3236,8 @@ bool ofxPixelBufferPlayer::isAllocated() const {
     }
 }
 
-int ofxPixelBufferPlayer::getWidth() const {
+template<typename T>
+int ofxPixelBufferPlayer_<T>::getWidth() const {
      if (myBufferPtr != nullptr){
         return myBufferPtr->getWidth();
     } else {
@@ -1184,7 +3245,8 @@ int ofxPixelBufferPlayer::getWidth() const {
     }
 }
 
-int ofxPixelBufferPlayer::getHeight() const {
+template<typename T>
+int ofxPixelBufferPlayer_<T>::getHeight() const {
      if (myBufferPtr != nullptr){
         return myBufferPtr->getHeight();
     } else {
@@ -1192,7 +3254,8 @@ int ofxPixelBufferPlayer::getHeight() const {
     }
 }
 
-int ofxPixelBufferPlayer::getNumChannels() const {
+template<typename T>
+int ofxPixelBufferPlayer_<T>::getNumChannels() const {
      if (myBufferPtr != nullptr){
         return myBufferPtr->getNumChannels();
     } else {
@@ -1201,3 +3264,20 @@ int ofxPixelBufferPlayer::getNumChannels() const {
 }
 
 
+
+
+template class ofxPixelBuffer_<unsigned char>;
+template class ofxPixelBuffer_<unsigned short>;
+template class ofxPixelBuffer_<float>;
+
+template class ofxPixelBufferRecorder_<unsigned char>;
+template class ofxPixelBufferRecorder_<unsigned short>;
+template class ofxPixelBufferRecorder_<float>;
+
+template class ofxPixelRingBuffer_<unsigned char>;
+template class ofxPixelRingBuffer_<unsigned short>;
+template class ofxPixelRingBuffer_<float>;
+
+template class ofxPixelBufferPlayer_<unsigned char>;
+template class ofxPixelBufferPlayer_<unsigned short>;
+template class ofxPixelBufferPlayer_<float>;
@@ -1,61 +1,275 @@
 #pragma once
 
 #include "ofMain.h"
+#include "ofxPixelBufferStream.h"
+#include "ofxPixelBufferCompressed.h"
+#include "ofxPixelBufferDelta.h"
+#include "ofxPixelBufferPool.h"
+#include "ofxPixelBufferKernels.h"
+#include "ofxPixelBufferStats.h"
+#include "ofxPixelBufferFileWriter.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <unordered_map>
 
 /// ofxPixelBuffer classes
+// all classes are templated on the pixel type (see ofPixels_) and instantiated for
+// unsigned char, unsigned short and float. the usual names are typedefs at the end of this file.
+
+// how the frames of an ofxPixelBuffer are stored in memory
+enum ofxPixelBufferStorage {
+    OFX_PIXEL_BUFFER_STORAGE_FRAMES, // every frame is a separate heap allocation (default)
+    OFX_PIXEL_BUFFER_STORAGE_SLAB, // all frames live in one contiguous, aligned block
+    OFX_PIXEL_BUFFER_STORAGE_MAPPED, // frames are views into a memory-mapped file (see loadMapped)
+    OFX_PIXEL_BUFFER_STORAGE_STREAMED, // frames are streamed from a file through a small cache (see loadStreamed)
+    OFX_PIXEL_BUFFER_STORAGE_COMPRESSED, // frames are compressed in memory and decoded through a small cache
+    OFX_PIXEL_BUFFER_STORAGE_DELTA // frames only store the tiles that changed since the previous frame
+};
+
+// how ofxPixelBufferPlayer computes frames between two buffer frames
+enum ofxPixelBufferInterpolation {
+    OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST, // round to the closest frame (default)
+    OFX_PIXEL_BUFFER_INTERPOLATION_LINEAR, // blend the 2 closest frames (see readLinear)
+    OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC // Catmull-Rom over the 4 closest frames (see readCubic)
+};
 
+class ofxPixelBufferFileMapping;
+template<typename T> class ofxPixelBufferPlayerGroup_;
+template<typename T> class ofxPixelRingBuffer_;
+template<typename T> class ofxPixelBufferPlayer_;
 
-class ofxPixelBuffer {
+template<typename T>
+class ofxPixelBuffer_ {
     protected:
-        deque<ofPixels> myBuffer;
+        deque<ofPixels_<T>> myBuffer;
         int myWidth, myHeight, myChannels, mySize;
         uint32_t myFrameSize;
         bool bAllocated;
         ofBaseVideoPlayer* myLoader;
         bool bThreaded;
-        ofPixels dummy;
+        ofPixels_<T> dummy;
+        const ofxPixelBufferKernels<T>* myKernels; // resolved once for this CPU
+        // slab storage: in this mode the ofPixels in myBuffer are non-owning views into mySlab
+        ofxPixelBufferStorage myStorage;
+        unsigned char* mySlab;
+        size_t mySlabStride; // frame size rounded up to the slab alignment
+        int mySlabFrames; // capacity of the slab in frames
+        vector<int> myFreeSlots; // unused frame slots, the next one to hand out is at the back
+        // mapped storage: the ofPixels in myBuffer are views into the file mapping
+        shared_ptr<ofxPixelBufferFileMapping> myMapping;
+        // streamed storage: myBuffer is empty, frames are read through the stream's cache
+        unique_ptr<ofxPixelBufferStream_<T>> myStream;
+        // compressed storage: myBuffer is empty, frames are decoded through a cache
+        unique_ptr<ofxPixelBufferCompressedFrames_<T>> myCompressed;
+        // delta storage: myBuffer is empty, frames are assembled from tiles through a cache
+        unique_ptr<ofxPixelBufferDeltaFrames_<T>> myDelta;
+        int myKeyframeInterval;
+        int myTileSize;
+        // frame storage: the ofPixels in myBuffer are views into reference counted blocks,
+        // which copies of the buffer share until one of them writes to the frame (copy-on-write).
+        struct Block {
+            shared_ptr<ofPixels_<T>> pixels;
+            int frames = 0; // frames of this buffer viewing the block
+        };
+        unordered_map<const T*, Block> myBlocks; // frame data -> block
+        // removed frames are recycled by push, insert and resize
+        shared_ptr<ofxPixelBufferFramePool_<T>> myPool;
+        mutable ofxPixelBufferCounters myCounters; // see getStats()
+        uint64_t myVersion; // see getVersion()
+
+        ofPixels_<T> newFrame();
+        ofPixels_<T> acquireFrame(); // a frame from the pool
+        void releaseFrame(ofPixels_<T>& frame);
+        void pushFrameFront(const ofPixels_<T>& myPixels);
+        void pushFrameBack(const ofPixels_<T>& myPixels);
+        ofPixels_<T> takeFrame(ofPixels_<T>& frame); // move or copy a frame out of the buffer
+        ofPixels_<T> adoptFrame(ofPixels_<T>&& pixels); // wrap into a block, returns a view
+        ofPixels_<T> viewBlock(const shared_ptr<ofPixels_<T>>& pixels);
+        void releaseBlock(typename unordered_map<const T*, Block>::iterator it);
+        bool isShared(const Block& block) const {return block.frames > 1 || block.pixels.use_count() > 1;}
+        ofPixels_<T> shareFrame(const ofxPixelBuffer_<T>& buffer, int index); // share (or copy) a frame of 'buffer'
+        // copy a shared frame before modifying it. keepPixels = false if it's overwritten anyway.
+        ofPixels_<T>& unshareFrame(int index, bool keepPixels = true);
+        void clearFrames();
+        bool checkPush(const vector<ofPixels_<T>>& frames);
+        void growSlab(int frames);
+        void freeStorage();
+        bool checkWritable() const;
+        const ofPixels_<T>& getFrame(int index) const; // no range check
+        // asynchronous movie loading
+        thread myLoadThread;
+        atomic<bool> bLoading;
+        atomic<bool> bCancelLoad;
+        atomic<int> myLoadedFrames;
+        atomic<int> myFramesToLoad;
+        int myLoadOnset;
+
+        bool isFrameLoading(int index) const; // the loader thread hasn't written this frame yet
+        int openMovie(const string& filePath, int numFrames, int frameOnset, int& bufferOnset);
+        bool decodeMovie(int bufferOnset, int length);
+        void copyFrom(const ofxPixelBuffer_<T>& mom);
+        void moveFrom(ofxPixelBuffer_<T>& mom);
+
+        friend class ofxPixelRingBuffer_<T>; // blends with myKernels
+        friend class ofxPixelBufferPlayer_<T>; // rounds weights like myKernels
     public:
         // constructors
-        ofxPixelBuffer();
-        ofxPixelBuffer(int width, int height, int channels, int frames);
-        ofxPixelBuffer(const ofPixels& pix, int frames);
+        ofxPixelBuffer_();
+        ofxPixelBuffer_(int width, int height, int channels, int frames);
+        ofxPixelBuffer_(const ofPixels_<T>& pix, int frames);
         // destructor
-        virtual ~ofxPixelBuffer() {}
+        virtual ~ofxPixelBuffer_();
         // copy constructor and assignment:
-        ofxPixelBuffer(const ofxPixelBuffer& mom);
-        ofxPixelBuffer& operator= (const ofxPixelBuffer& mom);
+        ofxPixelBuffer_(const ofxPixelBuffer_<T>& mom);
+        ofxPixelBuffer_<T>& operator= (const ofxPixelBuffer_<T>& mom);
         // move constructor and assignment:
-        ofxPixelBuffer(ofxPixelBuffer&& mom);
-        ofxPixelBuffer& operator= (ofxPixelBuffer&& mom);
+        ofxPixelBuffer_(ofxPixelBuffer_<T>&& mom);
+        ofxPixelBuffer_<T>& operator= (ofxPixelBuffer_<T>&& mom);
 
         void allocate(int width, int height, int channels, int frames);
-        void allocate(const ofPixels& pix, int frames);
+        void allocate(const ofPixels_<T>& pix, int frames);
         void resize(int size);
+        // make room for at least 'frames' frames (only has an effect on slab storage).
+        // growing the slab moves the frames, so references obtained through 'read' become invalid!
+        void reserve(int frames);
+        // switch the storage mode. existing frames are copied (or compressed) into the new storage.
+        // (mapped storage can only be created with loadMapped, streamed storage with loadStreamed)
+        void setStorage(ofxPixelBufferStorage storage);
+        ofxPixelBufferStorage getStorage() const {return myStorage;}
         void clearBuffer();
         void clearPixels();
         bool loadImage(const string filePath, int bufferOnset);
-        int loadMultiImage(const string filePath, int numFiles = -1, int startIndex = 0, int bufferOnset = 0);
+        // load a numbered image sequence (the path must contain a wildcard [*]).
+        // numThreads > 1 decodes on a worker pool, 0 = one thread per core.
+        int loadMultiImage(const string filePath, int numFiles = -1, int startIndex = 0, int bufferOnset = 0, int numThreads = 1);
+        // save frames [frameOnset, frameOnset + numFrames) as a numbered image sequence. the wildcard [*] is replaced
+        // by startIndex, startIndex + 1 etc., the file extension picks the format ('quality' is used for JPEG).
+        // numThreads > 1 encodes on a worker pool, 0 = one thread per core. don't modify the buffer while saving!
+        // returns for each frame whether it has been saved.
+        vector<bool> saveMultiImage(const string filePath, int frameOnset = 0, int numFrames = -1, int startIndex = 0,
+                                    ofImageQualityType quality = OF_IMAGE_QUALITY_BEST, int numThreads = 1) const;
         bool loadMovie(const string filePath, int numFrames = -1, int frameOnset = 0, int bufferOnset = 0);
         void setMovieLoader(ofBaseVideoPlayer& loader, bool isThreaded = false);
+        // save all frames as a raw file (see ofxPixelBufferFile.h)
+        bool save(const string filePath) const;
+        // memory-map a file written by save(). opens in no time, frames are paged in on demand.
+        // the frames can be modified, but changes are never written back to the file.
+        bool loadMapped(const string filePath);
+        // stream a file written by save(), keeping at most 'cacheFrames' frames in memory (read-only).
+        // a reference returned by read() stays valid until at least 3 other frames have been read.
+        bool loadStreamed(const string filePath, int cacheFrames = 64);
+        bool isStreamed() const {return myStorage == OFX_PIXEL_BUFFER_STORAGE_STREAMED;}
+        // streamed storage: load these frames in the background (most urgent first).
+        // ofxPixelBufferPlayer calls this automatically.
+        void prefetch(const vector<int>& frames);
+        int getPrefetchDepth() const; // number of frames a prefetch request should cover
+        ofxPixelBufferStreamStats getStreamStats() const;
+        void resetStreamStats();
+        // compressed storage (see setStorage): frames can only be changed with write(),
+        // switch back to FRAMES or SLAB storage for anything else.
+        // a reference returned by read() stays valid until at least 3 other frames have been read.
+        bool isCompressed() const {return myStorage == OFX_PIXEL_BUFFER_STORAGE_COMPRESSED;}
+        void setCompressionCacheSize(int frames); // decoded frames kept in memory (default: 8)
+        int getCompressionCacheSize() const;
+        ofxPixelBufferCompressionStats getCompressionStats() const;
+        void resetCompressionStats();
+        // delta storage (see setStorage): same restrictions as compressed storage.
+        // reading frames in order is cheap, because only the tiles that changed have to be copied.
+        bool isDeltaEncoded() const {return myStorage == OFX_PIXEL_BUFFER_STORAGE_DELTA;}
+        // every n-th frame stores all tiles (0 = only the first frame). takes effect on the next write.
+        void setKeyframeInterval(int frames);
+        int getKeyframeInterval() const {return myKeyframeInterval;}
+        // tile size in pixels (default: 32). takes effect when switching to delta storage.
+        void setDeltaTileSize(int pixels) {myTileSize = max(8, pixels);}
+        int getDeltaTileSize() const {return myTileSize;}
+        void setDeltaCacheSize(int frames); // assembled frames kept in memory (default: 8)
+        int getDeltaCacheSize() const;
+        ofxPixelBufferDeltaStats getDeltaStats() const;
+        void resetDeltaStats();
+        // frame storage: frames removed by pop, remove or resize go into a pool and are reused
+        // by push, insert and resize (default: up to 4 frames). buffers with the same dimensions
+        // can share a pool, e.g. to hand frames from one buffer to another without allocating.
+        void setFramePool(shared_ptr<ofxPixelBufferFramePool_<T>> pool);
+        shared_ptr<ofxPixelBufferFramePool_<T>> getFramePool() const {return myPool;}
+        void setFramePoolSize(int frames) {myPool->setCapacity(frames);} // 0 = disable recycling
+        ofxPixelBufferPoolStats getFramePoolStats() const {return myPool->getStats();}
+        // copies (copy constructor, getCopy, insert, replace) share the frames with the original.
+        // a shared frame is copied the first time it is written to. copying a buffer which is still
+        // loading a movie waits for the frames that aren't loaded yet. this is the number of frames
+        // this buffer currently shares with other buffers.
+        int getNumSharedFrames() const;
+        // true if both frames view the same memory (e.g. a frame inserted twice)
+        bool isSameFrame(int index1, int index2) const;
+        // changes with every modification of the frames (write, push, pop, load etc., getWritable and touch),
+        // so readers can tell if a result computed from the buffer is still up to date.
+        uint64_t getVersion() const {return myVersion;}
+        // bytes copied, frame allocations, blends and timings of write, readLinear and readCubic.
+        // only recorded if compiled with OFX_PIXEL_BUFFER_STATS (see ofxPixelBufferStats.h).
+        ofxPixelBufferStats getStats() const {return myCounters.getStats();}
+        void resetStats() {myCounters.reset();}
+        // load a movie on a background thread. the buffer is resized (or checked) before returning,
+        // frames [getLoadOnset(), getLoadOnset() + getNumLoadedFrames()) can already be read while loading.
+        // don't touch the movie loader or change the buffer size until loading has finished.
+        // write() and getWritable() refuse frames which haven't been loaded yet.
+        // 'callback' is called on the loader thread when done (false if failed or cancelled).
+        // it may start the next load or destroy the buffer. moving the buffer cancels the load,
+        // the frames loaded so far are kept.
+        shared_future<bool> loadMovieAsync(const string filePath, int numFrames = -1, int frameOnset = 0, int bufferOnset = 0,
+                                           function<void(bool)> callback = nullptr);
+        void cancelLoad(); // stop asynchronous loading and wait for the loader thread
+        bool isLoading() const {return bLoading;}
+        int getNumLoadedFrames() const {return myLoadedFrames.load(memory_order_acquire);}
+        int getNumFramesToLoad() const {return myFramesToLoad;}
+        int getLoadOnset() const {return myLoadOnset;}
+        float getLoadProgress() const; // 0 - 1
 
-        void write(int index, const ofPixels& myPixels);
-        const ofPixels& read (int index) const;
-        const ofPixels& operator[] (int index) const;
+        void write(int index, const ofPixels_<T>& myPixels);
+        // swaps the memory with the frame at 'index' (frame storage only, otherwise copies).
+        // afterwards myPixels holds the old frame, so it can be reused without allocating.
+        void write(int index, ofPixels_<T>&& myPixels);
+        // direct write access to a frame, e.g. to decode into the buffer's memory. don't reallocate it!
+        // call touch() when done, so results computed in the meantime count as outdated.
+        ofPixels_<T>& getWritable(int index);
+        void touch() {myVersion++;}
+        const ofPixels_<T>& read (int index) const;
+        const ofPixels_<T>& operator[] (int index) const;
         // read with linear interpolation. returns new ofPixels object.
-        ofPixels readLinear (float index) const;
-
-        void pushFront(const ofPixels& myPixels);
-        void pushFront(ofPixels&& myPixels);
-        void pushBack(const ofPixels& myPixels); // could pushing trigger a deque resize and therefore invalidate references obtained through 'read'?
-        void pushBack(ofPixels&& myPixels);
-        ofPixels popFront();
-        ofPixels popBack(); // could popping trigger a deque resize and therefore invalidate references obtained through 'read'?
-        void replace(const ofxPixelBuffer& buffer, int index = 0);
-        void replace(ofxPixelBuffer&& buffer, int index = 0);
-        void insert(const ofxPixelBuffer& buffer, int index);
-        void insert(ofxPixelBuffer&& buffer, int index);
+        ofPixels_<T> readLinear (float index) const;
+        // same as readLinear, but writes into 'out' and reuses its memory if the dimensions match.
+        void readLinearInto (float index, ofPixels_<T>& out) const;
+        // read with Catmull-Rom interpolation over the 4 neighbouring frames. smoother than readLinear
+        // when playing slowly. like readLinear, the last frame is followed by the first one.
+        ofPixels_<T> readCubic (float index) const;
+        void readCubicInto (float index, ofPixels_<T>& out) const;
+        // copy or blend only the pixels inside 'rect' (clipped to the frame) into 'out', which gets
+        // the size of the region. only the rows of the region are touched, so a small crop of a
+        // large frame is cheap. (streamed, compressed and delta frames are still fetched as a whole)
+        bool readRegion (int index, const ofRectangle& rect, ofPixels_<T>& out) const;
+        void readLinearRegion (float index, const ofRectangle& rect, ofPixels_<T>& out) const;
+
+        void pushFront(const ofPixels_<T>& myPixels);
+        void pushFront(ofPixels_<T>&& myPixels);
+        void pushBack(const ofPixels_<T>& myPixels); // could pushing trigger a deque resize and therefore invalidate references obtained through 'read'?
+        void pushBack(ofPixels_<T>&& myPixels);
+        // push several frames at once. nothing is pushed if any frame has the wrong dimensions.
+        // the rvalue version moves the frames (frame storage) and leaves 'frames' empty.
+        void pushBack(const vector<ofPixels_<T>>& frames);
+        void pushBack(vector<ofPixels_<T>>&& frames);
+        // the frame is moved out of the buffer (frame storage), other storage modes return a copy.
+        // popping an empty buffer returns empty pixels.
+        ofPixels_<T> popFront();
+        ofPixels_<T> popBack(); // could popping trigger a deque resize and therefore invalidate references obtained through 'read'?
+        // pop up to 'numFrames' frames and append them to 'out' (in buffer order). returns the number of frames.
+        int popFront(int numFrames, vector<ofPixels_<T>>& out);
+        int popBack(int numFrames, vector<ofPixels_<T>>& out);
+        void replace(const ofxPixelBuffer_<T>& buffer, int index = 0);
+        void replace(ofxPixelBuffer_<T>&& buffer, int index = 0);
+        void insert(const ofxPixelBuffer_<T>& buffer, int index);
+        void insert(ofxPixelBuffer_<T>&& buffer, int index);
         void remove(int index, int numFrames = -1); // -1 (negative) = till end of buffer
-        ofxPixelBuffer getCopy(int index, int numFrames = -1); // -1 (negative) = till end of buffer
+        ofxPixelBuffer_<T> getCopy(int index, int numFrames = -1); // -1 (negative) = till end of buffer
 
         int getWidth() const {return myWidth;}
         int getHeight() const {return myHeight;}
@@ -64,45 +278,125 @@ class ofxPixelBuffer {
         bool isAllocated() const {return bAllocated;}
 };
 
-class ofxPixelBufferRecorder {
+template<typename T>
+class ofxPixelBufferRecorder_ {
     protected:
-        ofxPixelBuffer* myBufferPtr;
+        ofxPixelBuffer_<T>* myBufferPtr;
         int myCounter;
         int myOnset;
         int myFrames;
         bool bRecord;
+        int myAcquiredIndex; // frame handed out by acquireWriteSlot() (-1 = none)
+        ofPixels_<T> myScratch; // write slot for buffers whose frames can't be written directly
+        ofxPixelBufferCounters myCounters;
+        // disk recording: frames go to the file instead of the buffer (copies share the writer)
+        shared_ptr<ofxPixelBufferFileWriter_<T>> myWriter;
+
+        bool checkInput(const ofPixels_<T>& myPixels);
+        bool hasTarget() const;
+        int nextIndex();
     public:
-        ofxPixelBufferRecorder() {myBufferPtr = nullptr; bRecord = false; myCounter = 0;}
-        ofxPixelBufferRecorder(ofxPixelBuffer& buffer) {setBuffer(buffer);}
+        ofxPixelBufferRecorder_() {myBufferPtr = nullptr; bRecord = false; myCounter = 0; myOnset = 0; myFrames = -1; myAcquiredIndex = -1;}
+        ofxPixelBufferRecorder_(ofxPixelBuffer_<T>& buffer) : ofxPixelBufferRecorder_() {setBuffer(buffer);}
 
-        void setBuffer(ofxPixelBuffer& buffer);
-        ofxPixelBuffer& getBuffer() {return *myBufferPtr;}
-        const ofxPixelBuffer& getBuffer() const {return *myBufferPtr;}
+        void setBuffer(ofxPixelBuffer_<T>& buffer);
+        ofxPixelBuffer_<T>& getBuffer() {return *myBufferPtr;}
+        const ofxPixelBuffer_<T>& getBuffer() const {return *myBufferPtr;}
 
-        void record(int onset = 0, int numFrames = -1);
+        // store keyframes plus the tiles that changed since the previous frame (see OFX_PIXEL_BUFFER_STORAGE_DELTA).
+        // switches the storage of the buffer, false = back to frame storage.
+        void setDeltaEncoding(bool delta, int keyframeInterval = 30, int tileSize = 32);
+        bool getDeltaEncoding() const {return myBufferPtr && myBufferPtr->isDeltaEncoded();}
+        void record(int onset = 0, int numFrames = -1); // closes the file (see recordToFile)
         void stop();
         void resume();
-        void in(const ofPixels& myPixels);
+        void in(const ofPixels_<T>& myPixels);
+        void in(ofPixels_<T>&& myPixels); // see ofxPixelBuffer::write(int, ofPixels&&)
+        // zero-copy recording: write the next frame directly into the buffer, then call commit().
+        // returns nullptr if not recording (anymore). compressed and delta encoded buffers
+        // hand out a scratch frame instead, which is encoded in commit().
+        ofPixels_<T>* acquireWriteSlot();
+        void commit();
+        // record into a raw file (see ofxPixelBuffer::save) instead of the buffer, so the length of the recording
+        // is only limited by the disk. in() hands the frames to a background thread and never waits for it:
+        // if 'queueFrames' frames are already waiting to be written, the frame is dropped.
+        // stop() and resume() pause the recording, closeFile() finishes it. a buffer isn't needed.
+        bool recordToFile(const string& filePath, int width, int height, int channels, int queueFrames = 16);
+        // waits until all queued frames are written. the file can then be opened with loadMapped / loadStreamed.
+        bool closeFile();
+        bool isRecordingToFile() const {return myWriter != nullptr;}
+        // queue depth, dropped frames and write throughput of the file recording
+        ofxPixelBufferWriterStats getFileStats() const;
         int getRecordedFrames() const {return myCounter;}
         int getCurrentIndex() const {return myOnset + myCounter;}
+        // timings of in() (only recorded if compiled with OFX_PIXEL_BUFFER_STATS).
+        // bytes copied etc. are counted by the buffer.
+        ofxPixelBufferStats getStats() const {return myCounters.getStats();}
+        void resetStats() {myCounters.reset();}
 };
 
-class ofxPixelRingBuffer {
+template<typename T>
+class ofxPixelRingBuffer_ {
     protected:
-        ofxPixelBuffer myBuffer;
-        int myIndex;
+        ofxPixelBuffer_<T> myBuffer;
+        atomic<int> myIndex; // slot of the next write, published after every frame
+        // concurrent (single producer / single consumer) mode:
+        // one extra slot is kept in reserve, so the producer never writes into a readable frame.
+        bool bConcurrent;
+        static const int numReadSlots = 4; // readCubicInto() blends 4 frames
+        mutable atomic<int> myReadSlots[numReadSlots]; // slots the consumer is copying from (-1 = none)
+        atomic<int> myDroppedFrames;
+        bool bAcquired; // a write slot has been handed out by acquireWriteSlot()
+        mutable ofxPixelBufferCounters myCounters;
+
+        bool canWrite(int index);
+        void publish(int index);
+
+        int acquireReadSlot(int index) const;
+        // announce the slots of the given frames and blend them into 'out'
+        void blendSlots(const int* frames, int count, float weight, const ofRectangle& rect, ofPixels_<T>& out) const;
+        void releaseReadSlots() const;
     public:
-        ofxPixelRingBuffer() {myIndex = 0;}
-        ofxPixelRingBuffer(int width, int height, int channels, int frames){myBuffer.allocate(width, height, channels, frames); myIndex = 0;}
-
-        void allocate(int width, int height, int channels, int frames){myBuffer.allocate(width, height, channels, frames); myIndex = 0;}
-        void in(const ofPixels& myPixels);
-        const ofPixels& read(int index) const;
-        ofPixels readLinear(float index) const;
-        void resize(int size){myBuffer.resize(size);}
+        ofxPixelRingBuffer_();
+        ofxPixelRingBuffer_(int width, int height, int channels, int frames);
+        ofxPixelRingBuffer_(const ofxPixelRingBuffer_<T>& mom);
+        ofxPixelRingBuffer_<T>& operator= (const ofxPixelRingBuffer_<T>& mom);
+
+        void allocate(int width, int height, int channels, int frames);
+        // single producer / single consumer mode: in() may be called from one thread while another thread reads.
+        // readInto() and readLinearInto() never see a half-written frame: if the producer would overwrite
+        // a frame the consumer is copying right now, the new frame is dropped instead (the producer never blocks).
+        // a reference returned by read() stays valid for at least (size() - index) more frames.
+        // call before starting the threads!
+        void setConcurrent(bool concurrent);
+        bool isConcurrent() const {return bConcurrent;}
+        int getNumDroppedFrames() const {return myDroppedFrames;}
+        // timings of in(), readLinear and readCubic plus the statistics of the underlying buffer
+        // (only recorded if compiled with OFX_PIXEL_BUFFER_STATS)
+        ofxPixelBufferStats getStats() const;
+        void resetStats();
+
+        void in(const ofPixels_<T>& myPixels);
+        void in(ofPixels_<T>&& myPixels); // see ofxPixelBuffer::write(int, ofPixels&&)
+        // zero-copy ingestion: write the next frame directly into the buffer, then call commit().
+        // returns nullptr if the frame has to be dropped (concurrent mode) or the buffer is empty.
+        ofPixels_<T>* acquireWriteSlot();
+        void commit();
+        const ofPixels_<T>& read(int index) const;
+        bool readInto(int index, ofPixels_<T>& out) const; // copy a frame
+        ofPixels_<T> readLinear(float index) const;
+        void readLinearInto(float index, ofPixels_<T>& out) const;
+        // the oldest and the newest frame are repeated at the ends instead of wrapping around
+        ofPixels_<T> readCubic(float index) const;
+        void readCubicInto(float index, ofPixels_<T>& out) const;
+        // see ofxPixelBuffer::readRegion. safe in concurrent mode, like readInto() and readLinearInto()
+        bool readRegion(int index, const ofRectangle& rect, ofPixels_<T>& out) const;
+        void readLinearRegion(float index, const ofRectangle& rect, ofPixels_<T>& out) const;
+        void resize(int size);
+        int size() const; // number of readable frames
         void clearBuffer(){myBuffer.clearPixels();}
-        const ofxPixelBuffer& getBuffer() const {return myBuffer;}
-        ofxPixelBuffer& getBuffer() {return myBuffer;}
+        const ofxPixelBuffer_<T>& getBuffer() const {return myBuffer;}
+        ofxPixelBuffer_<T>& getBuffer() {return myBuffer;}
         int getBufferPosition() {return myIndex;}
         bool isAllocated() {return myBuffer.isAllocated();}
         int getWidth() const {return myBuffer.getWidth();}
@@ -112,18 +406,35 @@ class ofxPixelRingBuffer {
 };
 
 
-class ofxPixelBufferPlayer {
+template<typename T>
+class ofxPixelBufferPlayer_ {
     protected:
-        ofxPixelBuffer* myBufferPtr;
-        ofPixels lerpPixels; // pointer to internal lerpPixels of ofxPixelBuffer
-        ofPixels dummy; // dummy ofPixels to return if something goes wrong
+        ofxPixelBuffer_<T>* myBufferPtr;
+        ofPixels_<T> lerpPixels; // interpolated frame, reused across updates
+        shared_ptr<const ofPixels_<T>> mySharedPixels; // interpolated frame handed out by a player group (replaces lerpPixels)
+        int mySourceFrame; // >= 0: the interpolation equals this frame, getPixels() hands it out directly
+        // what lerpPixels has been blended from. it's only blended again if something changed.
+        struct BlendKey {
+            const ofxPixelBuffer_<T>* buffer = nullptr;
+            uint64_t version = 0;
+            ofxPixelBufferInterpolation mode = OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST;
+            int frame = 0;
+            float weight = 0;
+            bool operator== (const BlendKey& key) const {
+                return buffer == key.buffer && version == key.version && mode == key.mode && frame == key.frame && weight == key.weight;
+            }
+        };
+        BlendKey myBlendKey;
+        BlendKey mySharedKey; // ... and mySharedPixels
+        ofPixels_<T> dummy; // dummy ofPixels to return if something goes wrong
 
         int64_t oldTime;
+        function<int64_t()> myClock; // see setClock()
         bool bPlay;
         bool bLoop;
         bool bLoopNew;
         bool bPingPong;
-        bool bLerp;
+        ofxPixelBufferInterpolation myInterpolation;
         float myFrameRate;
         float myPosition;
         float myTime;
@@ -135,25 +446,56 @@ class ofxPixelBufferPlayer {
         float myLoopSizeDev;
         float onset;
         float size;
+        vector<int> myPrefetchFrames;
+        ofxPixelBufferCounters myCounters;
+
+        void requestPrefetch(float delta);
+        bool checkBuffer() const;
+        int64_t now() const; // microseconds
+        // move the playhead by the time passed since the last update (or by 'dt' seconds).
+        // returns true if the interpolated frame has to be updated.
+        bool advance();
+        bool advance(double dt);
+        bool step(float delta);
+        // the first frame and the weight of the blend at 'position', as used by the kernels
+        void splitPosition(float position, int& frame, float& weight) const;
+        BlendKey getBlendKey(float position) const;
+        // the frame the interpolation at myPosition equals (-1 = has to be blended).
+        int findSourceFrame(int& frame, float& weight) const;
+        void interpolate(); // update lerpPixels at myPosition
+
+        friend class ofxPixelBufferPlayerGroup_<T>;
 
     public:
-        ofxPixelBufferPlayer();
-        ofxPixelBufferPlayer(ofxPixelBuffer& buffer);
+        ofxPixelBufferPlayer_();
+        ofxPixelBufferPlayer_(ofxPixelBuffer_<T>& buffer);
 
-        void setBuffer(ofxPixelBuffer& buffer);
+        void setBuffer(ofxPixelBuffer_<T>& buffer);
         bool hasBuffer() const;
-        ofxPixelBuffer* getBuffer() { return myBufferPtr; }
-        const ofxPixelBuffer* getBuffer() const { return myBufferPtr; }
+        ofxPixelBuffer_<T>* getBuffer() { return myBufferPtr; }
+        const ofxPixelBuffer_<T>* getBuffer() const { return myBufferPtr; }
 
         void update();
-        const ofPixels& getPixels() const;
-        void setInterpolation(bool mode) {bLerp = mode;}
-        bool getInterpolation() {return bLerp;}
+        // advance by 'dt' seconds instead of the time that has passed, e.g. to render offline
+        // faster than real time or to step through a loop in tests. update() continues from there.
+        void update(double dt);
+        // time source in microseconds, used by update(), play() and resume().
+        // nullptr = ofGetElapsedTimeMicros() (default).
+        void setClock(function<int64_t()> clock);
+        const ofPixels_<T>& getPixels() const;
+        void setInterpolation(ofxPixelBufferInterpolation mode) {myInterpolation = mode;}
+        // true = linear, false = nearest
+        void setInterpolation(bool mode) {myInterpolation = mode ? OFX_PIXEL_BUFFER_INTERPOLATION_LINEAR : OFX_PIXEL_BUFFER_INTERPOLATION_NEAREST;}
+        ofxPixelBufferInterpolation getInterpolation() const {return myInterpolation;}
+        // timings of update() (only recorded if compiled with OFX_PIXEL_BUFFER_STATS).
+        // blends etc. are counted by the buffer.
+        ofxPixelBufferStats getStats() const {return myCounters.getStats();}
+        void resetStats() {myCounters.reset();}
 
         void play(float frameOnset = 0);
         void stop() {bPlay = false; myTime = 0;}
         void pause() {bPlay = false;}
-        void resume(){bPlay = true; oldTime = ofGetElapsedTimeMicros();}
+        void resume();
         bool isPlaying() const {return bPlay;}
 
         void resetLoop();
@@ -192,3 +534,19 @@ class ofxPixelBufferPlayer {
 };
 
 
+
+// 8-bit pixels
+typedef ofxPixelBuffer_<unsigned char> ofxPixelBuffer;
+typedef ofxPixelBufferRecorder_<unsigned char> ofxPixelBufferRecorder;
+typedef ofxPixelRingBuffer_<unsigned char> ofxPixelRingBuffer;
+typedef ofxPixelBufferPlayer_<unsigned char> ofxPixelBufferPlayer;
+// 16-bit pixels (e.g. depth)
+typedef ofxPixelBuffer_<unsigned short> ofxShortPixelBuffer;
+typedef ofxPixelBufferRecorder_<unsigned short> ofxShortPixelBufferRecorder;
+typedef ofxPixelRingBuffer_<unsigned short> ofxShortPixelRingBuffer;
+typedef ofxPixelBufferPlayer_<unsigned short> ofxShortPixelBufferPlayer;
+// float pixels (e.g. HDR)
+typedef ofxPixelBuffer_<float> ofxFloatPixelBuffer;
+typedef ofxPixelBufferRecorder_<float> ofxFloatPixelBufferRecorder;
+typedef ofxPixelRingBuffer_<float> ofxFloatPixelRingBuffer;
+typedef ofxPixelBufferPlayer_<float> ofxFloatPixelBufferPlayer;
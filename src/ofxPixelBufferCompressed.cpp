@@ -0,0 +1,319 @@
+#include "ofxPixelBufferCompressed.h"
+
+#include <chrono>
+
+// row filters
+enum {
+    FILTER_SUB = 0, // difference to the pixel on the left
+    FILTER_UP = 1 // difference to the pixel above
+};
+
+// run tokens: 0-127 = 1-128 literal bytes follow, 128-254 = a run of 3-129 bytes,
+// 255 = a run of 130 + (varint) bytes. runs are followed by the repeated byte.
+static const int minRun = 3;
+static const int maxShortRun = 129;
+
+static void encodeRuns(const unsigned char* src, size_t size, vector<unsigned char>& dst){
+    size_t literalStart = 0;
+    auto flushLiterals = [&](size_t end){
+        while (literalStart < end){
+            size_t n = min<size_t>(128, end - literalStart);
+            dst.push_back(n - 1);
+            dst.insert(dst.end(), src + literalStart, src + literalStart + n);
+            literalStart += n;
+        }
+    };
+
+    size_t i = 0;
+    while (i < size){
+        size_t run = 1;
+        while (i + run < size && src[i + run] == src[i]){
+            run++;
+        }
+        if (run >= minRun){
+            flushLiterals(i);
+            if (run <= maxShortRun){
+                dst.push_back(128 + run - minRun);
+            } else {
+                dst.push_back(255);
+                uint64_t extra = run - maxShortRun - 1;
+                while (extra >= 128){
+                    dst.push_back((extra & 127) | 128);
+                    extra >>= 7;
+                }
+                dst.push_back(extra);
+            }
+            dst.push_back(src[i]);
+            literalStart = i + run;
+        }
+        i += run;
+    }
+    flushLiterals(size);
+}
+
+static bool decodeRuns(const unsigned char* src, size_t size, unsigned char* dst, size_t dstSize){
+    size_t pos = 0;
+    size_t out = 0;
+    while (out < dstSize){
+        if (pos >= size){
+            return false;
+        }
+        int token = src[pos++];
+        if (token < 128){
+            size_t n = token + 1;
+            if (pos + n > size || out + n > dstSize){
+                return false;
+            }
+            memcpy(dst + out, src + pos, n);
+            pos += n;
+            out += n;
+        } else {
+            size_t n;
+            if (token < 255){
+                n = token - 128 + minRun;
+            } else {
+                uint64_t extra = 0;
+                int shift = 0;
+                while (true){
+                    if (pos >= size || shift > 56){
+                        return false;
+                    }
+                    int byte = src[pos++];
+                    extra |= (uint64_t)(byte & 127) << shift;
+                    shift += 7;
+                    if (byte < 128){
+                        break;
+                    }
+                }
+                n = extra + maxShortRun + 1;
+            }
+            if (pos >= size || n > dstSize - out){
+                return false;
+            }
+            memset(dst + out, src[pos++], n);
+            out += n;
+        }
+    }
+    return pos == size;
+}
+
+void ofxPixelBufferEncodeFrame(const unsigned char* src, int width, int height, int channels, vector<unsigned char>& dst){
+    // scratch memory for the residuals, reused across calls
+    static thread_local vector<unsigned char> residuals;
+    size_t rowSize = (size_t)width * channels;
+    residuals.resize(rowSize * height);
+
+    dst.clear();
+    // one filter byte per row, followed by the runs
+    dst.resize(height);
+    for (int y = 0; y < height; ++y){
+        const unsigned char* row = src + y * rowSize;
+        const unsigned char* above = row - rowSize;
+        unsigned char* res = residuals.data() + y * rowSize;
+
+        int filter = FILTER_SUB;
+        if (y > 0){
+            // pick the filter which produces more zeros
+            size_t subZeros = 0;
+            size_t upZeros = 0;
+            for (size_t x = 0; x < rowSize; ++x){
+                unsigned char left = (x >= (size_t)channels) ? row[x - channels] : 0;
+                subZeros += (row[x] == left);
+                upZeros += (row[x] == above[x]);
+            }
+            if (upZeros > subZeros){
+                filter = FILTER_UP;
+            }
+        }
+        dst[y] = filter;
+
+        if (filter == FILTER_UP){
+            for (size_t x = 0; x < rowSize; ++x){
+                res[x] = row[x] - above[x];
+            }
+        } else {
+            for (int x = 0; x < channels && x < (int)rowSize; ++x){
+                res[x] = row[x];
+            }
+            for (size_t x = channels; x < rowSize; ++x){
+                res[x] = row[x] - row[x - channels];
+            }
+        }
+    }
+    encodeRuns(residuals.data(), residuals.size(), dst);
+}
+
+bool ofxPixelBufferDecodeFrame(const unsigned char* src, size_t size, int width, int height, int channels, unsigned char* dst){
+    size_t rowSize = (size_t)width * channels;
+    if (size < (size_t)height || !decodeRuns(src + height, size - height, dst, rowSize * height)){
+        return false;
+    }
+    // undo the row filters
+    for (int y = 0; y < height; ++y){
+        unsigned char* row = dst + y * rowSize;
+        if (src[y] == FILTER_UP && y > 0){
+            const unsigned char* above = row - rowSize;
+            for (size_t x = 0; x < rowSize; ++x){
+                row[x] += above[x];
+            }
+        } else if (src[y] == FILTER_SUB){
+            for (size_t x = channels; x < rowSize; ++x){
+                row[x] += row[x - channels];
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+ofxPixelBufferCompressedFrames_<T>::ofxPixelBufferCompressedFrames_(int width, int height, int channels, int cacheFrames){
+    myWidth = width;
+    myHeight = height;
+    myChannels = channels;
+    myFrameSize = (size_t)width * height * channels * sizeof(T);
+    myCompressedBytes = 0;
+    setCacheSize(cacheFrames);
+    resetStats();
+}
+
+template<typename T>
+ofxPixelBufferCompressedFrames_<T>::ofxPixelBufferCompressedFrames_(const ofxPixelBufferCompressedFrames_<T>& mom){
+    myWidth = mom.myWidth;
+    myHeight = mom.myHeight;
+    myChannels = mom.myChannels;
+    myFrameSize = mom.myFrameSize;
+    myFrames = mom.myFrames;
+    myCompressedBytes = mom.myCompressedBytes;
+    setCacheSize(mom.mySlots.size());
+    resetStats();
+}
+
+template<typename T>
+void ofxPixelBufferCompressedFrames_<T>::encode(const T* data, vector<unsigned char>& frame){
+    static thread_local vector<unsigned char> encoded;
+    auto t0 = chrono::steady_clock::now();
+    ofxPixelBufferEncodeFrame(reinterpret_cast<const unsigned char*>(data), myWidth, myHeight, myChannels * sizeof(T), encoded);
+    myStats.encodeTime += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    myCompressedBytes -= frame.size();
+    // don't keep the slack of the scratch vector around
+    frame.assign(encoded.begin(), encoded.end());
+    myCompressedBytes += frame.size();
+}
+
+template<typename T>
+void ofxPixelBufferCompressedFrames_<T>::pushBack(const T* data){
+    myFrames.emplace_back();
+    encode(data, myFrames.back());
+}
+
+template<typename T>
+void ofxPixelBufferCompressedFrames_<T>::write(int index, const T* data){
+    encode(data, myFrames[index]);
+    // keep the cache coherent
+    auto it = myFrameSlots.find(index);
+    if (it != myFrameSlots.end()){
+        memcpy(mySlots[it->second].pixels.getData(), data, myFrameSize);
+    }
+}
+
+template<typename T>
+bool ofxPixelBufferCompressedFrames_<T>::decode(int index, T* dst) const {
+    const vector<unsigned char>& frame = myFrames[index];
+    if (!ofxPixelBufferDecodeFrame(frame.data(), frame.size(), myWidth, myHeight, myChannels * sizeof(T),
+                                   reinterpret_cast<unsigned char*>(dst))){
+        cout << "couldn't decode frame " << index << "!\n";
+        memset(dst, 0, myFrameSize);
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+int ofxPixelBufferCompressedFrames_<T>::findVictim() const {
+    int victim = -1;
+    for (int i = 0; i < (int)mySlots.size(); ++i){
+        const Slot& slot = mySlots[i];
+        if (slot.frame < 0){
+            return i;
+        }
+        bool pinned = false;
+        for (int pin : myPins){
+            pinned = pinned || (pin == slot.frame);
+        }
+        if (!pinned && (victim < 0 || slot.lastUse < mySlots[victim].lastUse)){
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+template<typename T>
+const ofPixels_<T>& ofxPixelBufferCompressedFrames_<T>::getFrame(int index){
+    int slot;
+    auto it = myFrameSlots.find(index);
+    if (it != myFrameSlots.end()){
+        slot = it->second;
+        myStats.hits++;
+    } else {
+        slot = findVictim();
+        Slot& victim = mySlots[slot];
+        if (victim.frame >= 0){
+            myFrameSlots.erase(victim.frame);
+        }
+        if (!victim.pixels.isAllocated()){
+            victim.pixels.allocate(myWidth, myHeight, myChannels);
+        }
+        auto t0 = chrono::steady_clock::now();
+        decode(index, victim.pixels.getData());
+        myStats.decodeTime += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        myStats.misses++;
+        victim.frame = index;
+        myFrameSlots[index] = slot;
+    }
+    mySlots[slot].lastUse = ++myClock;
+    myPins[myPinIndex] = index;
+    myPinIndex = (myPinIndex + 1) % numPins;
+    return mySlots[slot].pixels;
+}
+
+template<typename T>
+void ofxPixelBufferCompressedFrames_<T>::setCacheSize(int frames){
+    // the pinned frames and at least one more must fit into the cache
+    frames = max(numPins + 1, frames);
+    // decoded frames are allocated on first use
+    mySlots.clear();
+    mySlots.resize(frames);
+    for (auto& slot : mySlots){
+        slot.frame = -1;
+        slot.lastUse = 0;
+    }
+    myFrameSlots.clear();
+    for (int i = 0; i < numPins; ++i){
+        myPins[i] = -1;
+    }
+    myPinIndex = 0;
+    myClock = 0;
+}
+
+template<typename T>
+ofxPixelBufferCompressionStats ofxPixelBufferCompressedFrames_<T>::getStats() const {
+    ofxPixelBufferCompressionStats stats = myStats;
+    stats.rawBytes = (uint64_t)myFrames.size() * myFrameSize;
+    stats.compressedBytes = myCompressedBytes;
+    stats.ratio = myCompressedBytes > 0 ? (double)stats.rawBytes / myCompressedBytes : 0.f;
+    stats.cached = myFrameSlots.size();
+    stats.capacity = mySlots.size();
+    return stats;
+}
+
+template<typename T>
+void ofxPixelBufferCompressedFrames_<T>::resetStats(){
+    myStats = ofxPixelBufferCompressionStats();
+}
+
+template class ofxPixelBufferCompressedFrames_<unsigned char>;
+template class ofxPixelBufferCompressedFrames_<unsigned short>;
+template class ofxPixelBufferCompressedFrames_<float>;
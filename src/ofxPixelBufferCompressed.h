@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <unordered_map>
+
+struct ofxPixelBufferCompressionStats {
+    uint64_t rawBytes; // size of the frames without compression
+    uint64_t compressedBytes;
+    float ratio; // rawBytes / compressedBytes
+    uint64_t hits; // frame was in the decoded-frame cache
+    uint64_t misses; // frame had to be decoded
+    double decodeTime; // total seconds spent decoding
+    double encodeTime; // total seconds spent encoding
+    int cached; // decoded frames currently in the cache
+    int capacity;
+};
+
+// lossless frame codec: every row is filtered with its left ('sub') or upper ('up') neighbour,
+// whichever yields more zero bytes, and the residuals are run-length encoded across rows.
+// frames are encoded independently, so any frame can be decoded without the others.
+void ofxPixelBufferEncodeFrame(const unsigned char* src, int width, int height, int channels, vector<unsigned char>& dst);
+bool ofxPixelBufferDecodeFrame(const unsigned char* src, size_t size, int width, int height, int channels, unsigned char* dst);
+
+// compressed frames + a small LRU cache of decoded frames.
+// frames of 16-bit or float pixels are compressed as if they had channels * sizeof(T) 8-bit channels.
+template<typename T>
+class ofxPixelBufferCompressedFrames_ {
+    protected:
+        struct Slot {
+            ofPixels_<T> pixels;
+            int frame;
+            uint64_t lastUse;
+        };
+        static const int numPins = 4;
+
+        int myWidth;
+        int myHeight;
+        int myChannels;
+        size_t myFrameSize; // in bytes
+        deque<vector<unsigned char>> myFrames;
+        vector<Slot> mySlots;
+        unordered_map<int, int> myFrameSlots; // frame -> slot
+        int myPins[numPins]; // the most recently read frames are never evicted
+        int myPinIndex;
+        uint64_t myClock;
+        uint64_t myCompressedBytes;
+        ofxPixelBufferCompressionStats myStats;
+
+        void encode(const T* data, vector<unsigned char>& frame);
+        int findVictim() const;
+    public:
+        ofxPixelBufferCompressedFrames_(int width, int height, int channels, int cacheFrames = 8);
+        // copies the compressed frames, the cache starts empty
+        ofxPixelBufferCompressedFrames_(const ofxPixelBufferCompressedFrames_<T>& mom);
+        ofxPixelBufferCompressedFrames_<T>& operator= (const ofxPixelBufferCompressedFrames_<T>&) = delete;
+
+        void pushBack(const T* data);
+        void write(int index, const T* data);
+        // decode a frame without touching the cache
+        bool decode(int index, T* dst) const;
+        // get a decoded frame. only call from one thread!
+        // the reference stays valid until at least 3 other frames have been read.
+        const ofPixels_<T>& getFrame(int index);
+        int size() const {return myFrames.size();}
+
+        void setCacheSize(int frames);
+        int getCacheSize() const {return mySlots.size();}
+        ofxPixelBufferCompressionStats getStats() const;
+        void resetStats();
+};
+
+typedef ofxPixelBufferCompressedFrames_<unsigned char> ofxPixelBufferCompressedFrames;
@@ -0,0 +1,250 @@
+#include "ofxPixelBufferDelta.h"
+#include "ofxPixelBufferKernels.h"
+
+#include <chrono>
+#include <unordered_set>
+
+template<typename T>
+ofxPixelBufferDeltaFrames_<T>::ofxPixelBufferDeltaFrames_(int width, int height, int channels, int keyframeInterval, int tileSize, int cacheFrames){
+    myWidth = width;
+    myHeight = height;
+    myChannels = channels;
+    myFrameSize = (size_t)width * height * channels * sizeof(T);
+    myTileSize = max(8, tileSize);
+    myTilesX = (width + myTileSize - 1) / myTileSize;
+    myTilesY = (height + myTileSize - 1) / myTileSize;
+    setKeyframeInterval(keyframeInterval);
+    setCacheSize(cacheFrames);
+    resetStats();
+}
+
+template<typename T>
+ofxPixelBufferDeltaFrames_<T>::ofxPixelBufferDeltaFrames_(const ofxPixelBufferDeltaFrames_<T>& mom){
+    myWidth = mom.myWidth;
+    myHeight = mom.myHeight;
+    myChannels = mom.myChannels;
+    myFrameSize = mom.myFrameSize;
+    myTileSize = mom.myTileSize;
+    myTilesX = mom.myTilesX;
+    myTilesY = mom.myTilesY;
+    myKeyframeInterval = mom.myKeyframeInterval;
+    // the tiles are never changed while shared, so we can simply share them
+    myFrames = mom.myFrames;
+    setCacheSize(mom.mySlots.size());
+    resetStats();
+}
+
+template<typename T>
+bool ofxPixelBufferDeltaFrames_<T>::isKeyframe(int index) const {
+    return myKeyframeInterval > 0 ? (index % myKeyframeInterval == 0) : (index == 0);
+}
+
+template<typename T>
+void ofxPixelBufferDeltaFrames_<T>::getTileRect(int tile, size_t& offset, size_t& rowSize, int& rows) const {
+    int x = (tile % myTilesX) * myTileSize;
+    int y = (tile / myTilesX) * myTileSize;
+    offset = ((size_t)y * myWidth + x) * myChannels * sizeof(T);
+    rowSize = (size_t)min(myTileSize, myWidth - x) * myChannels * sizeof(T);
+    rows = min(myTileSize, myHeight - y);
+}
+
+template<typename T>
+bool ofxPixelBufferDeltaFrames_<T>::tileEquals(const unsigned char* data, int tile, const vector<unsigned char>& stored) const {
+    size_t offset, rowSize;
+    int rows;
+    getTileRect(tile, offset, rowSize, rows);
+    size_t stride = (size_t)myWidth * myChannels * sizeof(T);
+    for (int y = 0; y < rows; ++y){
+        if (!ofxPixelBufferEqual(data + offset + y * stride, stored.data() + y * rowSize, rowSize)){
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+void ofxPixelBufferDeltaFrames_<T>::pushBack(const T* data){
+    myFrames.emplace_back();
+    myFrames.back().tiles.resize(myTilesX * myTilesY);
+    write(myFrames.size() - 1, data);
+}
+
+template<typename T>
+void ofxPixelBufferDeltaFrames_<T>::write(int index, const T* pixels){
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(pixels);
+    auto t0 = chrono::steady_clock::now();
+    Frame& frame = myFrames[index];
+    const Frame* prev = (index > 0 && !isKeyframe(index)) ? &myFrames[index - 1] : nullptr;
+    size_t stride = (size_t)myWidth * myChannels * sizeof(T);
+    int numTiles = myTilesX * myTilesY;
+    for (int i = 0; i < numTiles; ++i){
+        Tile& tile = frame.tiles[i];
+        if (prev && prev->tiles[i] && tileEquals(data, i, *prev->tiles[i])){
+            tile = prev->tiles[i];
+            myStats.tilesSkipped++;
+            continue;
+        }
+        size_t offset, rowSize;
+        int rows;
+        getTileRect(i, offset, rowSize, rows);
+        // reuse the memory if nobody else (frame or cache) holds on to the tile
+        if (!tile || tile.use_count() > 1){
+            tile = make_shared<vector<unsigned char>>(rowSize * rows);
+        }
+        for (int y = 0; y < rows; ++y){
+            memcpy(tile->data() + y * rowSize, data + offset + y * stride, rowSize);
+        }
+        myStats.tilesWritten++;
+    }
+    myStats.encodeTime += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    // the cached copy is outdated, but it still matches its own tiles,
+    // so the slot can be reused for assembling other frames.
+    auto it = myFrameSlots.find(index);
+    if (it != myFrameSlots.end()){
+        mySlots[it->second].frame = -1;
+        myFrameSlots.erase(it);
+    }
+}
+
+// copy all tiles which differ from the ones the slot has been assembled from
+template<typename T>
+void ofxPixelBufferDeltaFrames_<T>::assemble(const Frame& frame, Slot& slot){
+    unsigned char* dst = reinterpret_cast<unsigned char*>(slot.pixels.getData());
+    size_t stride = (size_t)myWidth * myChannels * sizeof(T);
+    int numTiles = frame.tiles.size();
+    for (int i = 0; i < numTiles; ++i){
+        if (slot.tiles[i] == frame.tiles[i]){
+            continue;
+        }
+        size_t offset, rowSize;
+        int rows;
+        getTileRect(i, offset, rowSize, rows);
+        const unsigned char* src = frame.tiles[i]->data();
+        for (int y = 0; y < rows; ++y){
+            memcpy(dst + offset + y * stride, src + y * rowSize, rowSize);
+        }
+        slot.tiles[i] = frame.tiles[i];
+        myStats.tilesCopied++;
+    }
+}
+
+template<typename T>
+void ofxPixelBufferDeltaFrames_<T>::decode(int index, T* pixels) const {
+    unsigned char* dst = reinterpret_cast<unsigned char*>(pixels);
+    const Frame& frame = myFrames[index];
+    size_t stride = (size_t)myWidth * myChannels * sizeof(T);
+    int numTiles = frame.tiles.size();
+    for (int i = 0; i < numTiles; ++i){
+        size_t offset, rowSize;
+        int rows;
+        getTileRect(i, offset, rowSize, rows);
+        const unsigned char* src = frame.tiles[i]->data();
+        for (int y = 0; y < rows; ++y){
+            memcpy(dst + offset + y * stride, src + y * rowSize, rowSize);
+        }
+    }
+}
+
+template<typename T>
+int ofxPixelBufferDeltaFrames_<T>::findVictim() const {
+    int victim = -1;
+    for (int i = 0; i < (int)mySlots.size(); ++i){
+        const Slot& slot = mySlots[i];
+        if (slot.frame < 0){
+            return i;
+        }
+        bool pinned = false;
+        for (int pin : myPins){
+            pinned = pinned || (pin == slot.frame);
+        }
+        if (!pinned && (victim < 0 || slot.lastUse < mySlots[victim].lastUse)){
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+template<typename T>
+const ofPixels_<T>& ofxPixelBufferDeltaFrames_<T>::getFrame(int index){
+    int slot;
+    auto it = myFrameSlots.find(index);
+    if (it != myFrameSlots.end()){
+        slot = it->second;
+        myStats.hits++;
+    } else {
+        // when playing sequentially the least recently used frame is close to the new one,
+        // so only the tiles which changed in between have to be copied.
+        slot = findVictim();
+        Slot& victim = mySlots[slot];
+        if (victim.frame >= 0){
+            myFrameSlots.erase(victim.frame);
+        }
+        if (!victim.pixels.isAllocated()){
+            victim.pixels.allocate(myWidth, myHeight, myChannels);
+            victim.tiles.assign(myTilesX * myTilesY, nullptr);
+        }
+        auto t0 = chrono::steady_clock::now();
+        assemble(myFrames[index], victim);
+        myStats.decodeTime += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        myStats.misses++;
+        victim.frame = index;
+        myFrameSlots[index] = slot;
+    }
+    mySlots[slot].lastUse = ++myClock;
+    myPins[myPinIndex] = index;
+    myPinIndex = (myPinIndex + 1) % numPins;
+    return mySlots[slot].pixels;
+}
+
+template<typename T>
+void ofxPixelBufferDeltaFrames_<T>::setCacheSize(int frames){
+    // the pinned frames and at least one more must fit into the cache
+    frames = max(numPins + 1, frames);
+    // decoded frames are allocated on first use
+    mySlots.clear();
+    mySlots.resize(frames);
+    for (auto& slot : mySlots){
+        slot.frame = -1;
+        slot.lastUse = 0;
+    }
+    myFrameSlots.clear();
+    for (int i = 0; i < numPins; ++i){
+        myPins[i] = -1;
+    }
+    myPinIndex = 0;
+    myClock = 0;
+}
+
+template<typename T>
+ofxPixelBufferDeltaStats ofxPixelBufferDeltaFrames_<T>::getStats() const {
+    ofxPixelBufferDeltaStats stats = myStats;
+    stats.rawBytes = (uint64_t)myFrames.size() * myFrameSize;
+    // count shared tiles only once
+    unordered_set<const vector<unsigned char>*> tiles;
+    stats.storedBytes = 0;
+    for (auto& frame : myFrames){
+        for (auto& tile : frame.tiles){
+            if (tile && tiles.insert(tile.get()).second){
+                stats.storedBytes += tile->size();
+            }
+        }
+    }
+    stats.ratio = stats.storedBytes > 0 ? (double)stats.rawBytes / stats.storedBytes : 0.f;
+    stats.keyframes = 0;
+    for (int i = 0; i < (int)myFrames.size(); ++i){
+        stats.keyframes += isKeyframe(i);
+    }
+    stats.cached = myFrameSlots.size();
+    stats.capacity = mySlots.size();
+    return stats;
+}
+
+template<typename T>
+void ofxPixelBufferDeltaFrames_<T>::resetStats(){
+    myStats = ofxPixelBufferDeltaStats();
+}
+
+template class ofxPixelBufferDeltaFrames_<unsigned char>;
+template class ofxPixelBufferDeltaFrames_<unsigned short>;
+template class ofxPixelBufferDeltaFrames_<float>;
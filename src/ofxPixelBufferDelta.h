@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <unordered_map>
+
+struct ofxPixelBufferDeltaStats {
+    uint64_t rawBytes; // size of the frames without delta encoding
+    uint64_t storedBytes; // tiles actually kept in memory (shared tiles are counted once)
+    float ratio; // rawBytes / storedBytes
+    int keyframes;
+    uint64_t tilesWritten; // tiles that changed and had to be stored
+    uint64_t tilesSkipped; // tiles that were shared with the previous frame
+    uint64_t hits; // frame was in the decoded-frame cache
+    uint64_t misses; // frame had to be reconstructed
+    uint64_t tilesCopied; // tiles copied while reconstructing frames
+    double decodeTime; // total seconds spent reconstructing frames
+    double encodeTime; // total seconds spent comparing and storing tiles
+    int cached; // decoded frames currently in the cache
+    int capacity;
+};
+
+// frames split into tiles. a tile which didn't change since the previous frame is not stored again,
+// the frame just shares it with its predecessor. every 'keyframeInterval' frames all tiles are stored.
+// tiles are immutable once shared, so frames never depend on each other and can be written in any order.
+template<typename T>
+class ofxPixelBufferDeltaFrames_ {
+    protected:
+        typedef shared_ptr<vector<unsigned char>> Tile;
+        struct Frame {
+            vector<Tile> tiles;
+        };
+        struct Slot {
+            ofPixels_<T> pixels;
+            vector<Tile> tiles; // the tiles the pixels have been assembled from
+            int frame;
+            uint64_t lastUse;
+        };
+        static const int numPins = 4;
+
+        int myWidth;
+        int myHeight;
+        int myChannels;
+        size_t myFrameSize; // in bytes
+        int myTileSize;
+        int myTilesX;
+        int myTilesY;
+        int myKeyframeInterval;
+        deque<Frame> myFrames;
+        vector<Slot> mySlots;
+        unordered_map<int, int> myFrameSlots; // frame -> slot
+        int myPins[numPins]; // the most recently read frames are never evicted
+        int myPinIndex;
+        uint64_t myClock;
+        ofxPixelBufferDeltaStats myStats;
+
+        bool isKeyframe(int index) const;
+        // byte offset of a tile in the frame, its row size and number of rows
+        void getTileRect(int tile, size_t& offset, size_t& rowSize, int& rows) const;
+        bool tileEquals(const unsigned char* data, int tile, const vector<unsigned char>& stored) const;
+        void assemble(const Frame& frame, Slot& slot);
+        int findVictim() const;
+    public:
+        ofxPixelBufferDeltaFrames_(int width, int height, int channels, int keyframeInterval = 30, int tileSize = 32, int cacheFrames = 8);
+        // shares the tiles with mom, the cache starts empty
+        ofxPixelBufferDeltaFrames_(const ofxPixelBufferDeltaFrames_<T>& mom);
+        ofxPixelBufferDeltaFrames_<T>& operator= (const ofxPixelBufferDeltaFrames_<T>&) = delete;
+
+        void pushBack(const T* data);
+        void write(int index, const T* data);
+        // reconstruct a frame without touching the cache
+        void decode(int index, T* dst) const;
+        // get a reconstructed frame. only call from one thread!
+        // the reference stays valid until at least 3 other frames have been read.
+        const ofPixels_<T>& getFrame(int index);
+        int size() const {return myFrames.size();}
+
+        // 0 = only the first frame is a keyframe. takes effect on the next write.
+        void setKeyframeInterval(int frames) {myKeyframeInterval = max(0, frames);}
+        int getKeyframeInterval() const {return myKeyframeInterval;}
+        int getTileSize() const {return myTileSize;}
+        void setCacheSize(int frames);
+        int getCacheSize() const {return mySlots.size();}
+        ofxPixelBufferDeltaStats getStats() const; // walks all tiles
+        void resetStats();
+};
+
+typedef ofxPixelBufferDeltaFrames_<unsigned char> ofxPixelBufferDeltaFrames;
@@ -0,0 +1,151 @@
+#include "ofxPixelBufferFile.h"
+
+#include <climits>
+#include <cstdint>
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char fileMagic[8] = "OFXPBUF";
+static const uint32_t fileVersion = 1;
+static const uint32_t fileDataOffset = 4096;
+static const uint64_t fileAlignment = 64;
+
+/// ofxPixelBufferFileHeader
+
+ofxPixelBufferFileHeader::ofxPixelBufferFileHeader()
+    : magic(), version(0), dataOffset(0), width(0), height(0), channels(0), bytesPerChannel(0),
+      numFrames(0), frameSize(0), frameStride(0), alignment(0) {}
+
+ofxPixelBufferFileHeader::ofxPixelBufferFileHeader(int width, int height, int channels, int bytesPerChannel, uint64_t numFrames)
+    : ofxPixelBufferFileHeader() {
+    memcpy(magic, fileMagic, sizeof(magic));
+    version = fileVersion;
+    dataOffset = fileDataOffset;
+    this->width = width;
+    this->height = height;
+    this->channels = channels;
+    this->bytesPerChannel = bytesPerChannel;
+    this->numFrames = numFrames;
+    frameSize = static_cast<uint64_t>(width) * height * channels * bytesPerChannel;
+    alignment = fileAlignment;
+    frameStride = (frameSize + alignment - 1) / alignment * alignment;
+}
+
+bool ofxPixelBufferFileHeader::isValid() const {
+    // the header might be corrupt (or crafted), so make sure none of the sizes overflow
+    return !memcmp(magic, fileMagic, sizeof(magic)) && version == fileVersion
+        && dataOffset >= sizeof(ofxPixelBufferFileHeader)
+        && width > 0 && height > 0 && channels >= 1 && channels <= 4 && bytesPerChannel > 0 && bytesPerChannel <= 8
+        && static_cast<uint64_t>(width) * height <= UINT64_MAX / (channels * bytesPerChannel)
+        && frameSize == static_cast<uint64_t>(width) * height * channels * bytesPerChannel
+        && alignment > 0 && frameStride >= frameSize && frameStride % alignment == 0
+        && numFrames <= static_cast<uint64_t>(INT_MAX) && numFrames <= (UINT64_MAX - dataOffset) / frameStride;
+}
+
+bool ofxPixelBufferFileHeader::fitsInto(uint64_t size) const {
+    return size >= dataOffset && numFrames <= (size - dataOffset) / frameStride;
+}
+
+bool ofxPixelBufferWriteFileHeader(FILE* file, const ofxPixelBufferFileHeader& header){
+    vector<char> block(header.dataOffset, 0);
+    memcpy(block.data(), &header, sizeof(header));
+    return fwrite(block.data(), 1, block.size(), file) == block.size();
+}
+
+bool ofxPixelBufferReadFileHeader(FILE* file, ofxPixelBufferFileHeader& header){
+    if (fread(&header, sizeof(header), 1, file) != 1){
+        return false;
+    }
+    return header.isValid();
+}
+
+/// ofxPixelBufferFileMapping
+
+ofxPixelBufferFileMapping::ofxPixelBufferFileMapping(){
+    myData = nullptr;
+    mySize = 0;
+#ifdef TARGET_WIN32
+    myFile = INVALID_HANDLE_VALUE;
+    myMapping = nullptr;
+#endif
+}
+
+ofxPixelBufferFileMapping::~ofxPixelBufferFileMapping(){
+    close();
+}
+
+bool ofxPixelBufferFileMapping::open(const string& filePath){
+    close();
+#ifdef TARGET_WIN32
+    myFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (myFile == INVALID_HANDLE_VALUE){
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(myFile, &size) || size.QuadPart == 0){
+        close();
+        return false;
+    }
+    // copy-on-write: the frames can be modified without touching the file
+    myMapping = CreateFileMappingA(myFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (!myMapping){
+        close();
+        return false;
+    }
+    myData = static_cast<unsigned char*>(MapViewOfFile(myMapping, FILE_MAP_COPY, 0, 0, 0));
+    if (!myData){
+        close();
+        return false;
+    }
+    mySize = size.QuadPart;
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0){
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0){
+        ::close(fd);
+        return false;
+    }
+    // copy-on-write: the frames can be modified without touching the file
+    void* data = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (data == MAP_FAILED){
+        return false;
+    }
+    myData = static_cast<unsigned char*>(data);
+    mySize = info.st_size;
+#endif
+    return true;
+}
+
+void ofxPixelBufferFileMapping::close(){
+#ifdef TARGET_WIN32
+    if (myData){
+        UnmapViewOfFile(myData);
+    }
+    if (myMapping){
+        CloseHandle(myMapping);
+        myMapping = nullptr;
+    }
+    if (myFile != INVALID_HANDLE_VALUE){
+        CloseHandle(myFile);
+        myFile = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (myData){
+        munmap(myData, mySize);
+    }
+#endif
+    myData = nullptr;
+    mySize = 0;
+}
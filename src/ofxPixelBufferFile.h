@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ofMain.h"
+
+/// raw ofxPixelBuffer file format
+// [header][padding up to dataOffset][frame 0][padding up to frameStride][frame 1]...
+// all fields are stored in native byte order. frames are stored uncompressed,
+// so the whole file can be memory-mapped.
+
+struct ofxPixelBufferFileHeader {
+    char magic[8]; // "OFXPBUF"
+    uint32_t version;
+    uint32_t dataOffset; // offset of the first frame (page aligned)
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t bytesPerChannel;
+    uint64_t numFrames;
+    uint64_t frameSize; // in bytes
+    uint64_t frameStride; // frameSize rounded up to the alignment
+    uint64_t alignment;
+
+    ofxPixelBufferFileHeader();
+    ofxPixelBufferFileHeader(int width, int height, int channels, int bytesPerChannel, uint64_t numFrames);
+
+    bool isValid() const;
+    // true if a file of 'size' bytes holds all frames (call isValid() first)
+    bool fitsInto(uint64_t size) const;
+    uint64_t getFrameOffset(uint64_t frame) const {return dataOffset + frame * frameStride;}
+    uint64_t getFileSize() const {return getFrameOffset(numFrames);}
+};
+
+// write the header (including the padding up to the first frame)
+bool ofxPixelBufferWriteFileHeader(FILE* file, const ofxPixelBufferFileHeader& header);
+// read and validate the header
+bool ofxPixelBufferReadFileHeader(FILE* file, ofxPixelBufferFileHeader& header);
+
+// a private (copy-on-write) memory mapping of a whole file.
+// pages are loaded on demand, writes never go back to the file.
+class ofxPixelBufferFileMapping {
+    protected:
+        unsigned char* myData;
+        size_t mySize;
+#ifdef TARGET_WIN32
+        void* myFile;
+        void* myMapping;
+#endif
+    public:
+        ofxPixelBufferFileMapping();
+        ~ofxPixelBufferFileMapping();
+        ofxPixelBufferFileMapping(const ofxPixelBufferFileMapping&) = delete;
+        ofxPixelBufferFileMapping& operator= (const ofxPixelBufferFileMapping&) = delete;
+
+        bool open(const string& filePath);
+        void close();
+        unsigned char* getData() const {return myData;}
+        size_t getSize() const {return mySize;}
+        bool isOpen() const {return myData != nullptr;}
+};
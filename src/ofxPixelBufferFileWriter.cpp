@@ -0,0 +1,171 @@
+#include "ofxPixelBufferFileWriter.h"
+
+#include <chrono>
+
+template<typename T>
+ofxPixelBufferFileWriter_<T>::ofxPixelBufferFileWriter_(){
+    myFile = nullptr;
+    myStats = ofxPixelBufferWriterStats();
+    myPushing = 0;
+    bClosing = false;
+}
+
+template<typename T>
+ofxPixelBufferFileWriter_<T>::~ofxPixelBufferFileWriter_(){
+    close();
+}
+
+template<typename T>
+bool ofxPixelBufferFileWriter_<T>::open(const string& filePath, int width, int height, int channels, int queueFrames){
+    close();
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4){
+        cout << "bad dimensions!\n";
+        return false;
+    }
+    FILE* file = fopen(ofToDataPath(filePath).c_str(), "wb");
+    if (!file){
+        cout << "couldn't open " << filePath << "!\n";
+        return false;
+    }
+    // the number of frames is filled in by close()
+    ofxPixelBufferFileHeader header(width, height, channels, sizeof(T), 0);
+    if (!ofxPixelBufferWriteFileHeader(file, header)){
+        cout << "couldn't write " << filePath << "!\n";
+        fclose(file);
+        return false;
+    }
+
+    // push() might be called concurrently and drop frames until we're done
+    lock_guard<mutex> lock(myMutex);
+    myPath = filePath;
+    myFile = file;
+    myHeader = header;
+    // allocate all slots up front, so push() never allocates
+    queueFrames = max(1, queueFrames);
+    mySlots.resize(queueFrames);
+    myFreeSlots.clear();
+    for (int i = 0; i < queueFrames; ++i){
+        if ((int)mySlots[i].getWidth() != width || (int)mySlots[i].getHeight() != height
+                || (int)mySlots[i].getNumChannels() != channels){
+            mySlots[i].allocate(width, height, channels);
+        }
+        myFreeSlots.push_back(i);
+    }
+    myQueue.clear();
+    myPushing = 0;
+    myStats = ofxPixelBufferWriterStats();
+    myStats.queueCapacity = queueFrames;
+    bClosing = false;
+    myThread = thread(&ofxPixelBufferFileWriter_<T>::run, this);
+    return true;
+}
+
+template<typename T>
+bool ofxPixelBufferFileWriter_<T>::push(const ofPixels_<T>& pixels){
+    int slot;
+    {
+        lock_guard<mutex> lock(myMutex);
+        if (!myFile || bClosing || myStats.error || myFreeSlots.empty()
+                || pixels.getWidth() != myHeader.width || pixels.getHeight() != myHeader.height
+                || pixels.getNumChannels() != myHeader.channels){
+            myStats.framesDropped++;
+            return false;
+        }
+        slot = myFreeSlots.back();
+        myFreeSlots.pop_back();
+        // the writer thread doesn't finish before the slot is queued
+        myPushing++;
+    }
+    // the slot belongs to us until it's queued
+    memcpy(mySlots[slot].getData(), pixels.getData(), myHeader.frameSize);
+    {
+        lock_guard<mutex> lock(myMutex);
+        myQueue.push_back(slot);
+        myPushing--;
+    }
+    myCondition.notify_one();
+    return true;
+}
+
+template<typename T>
+void ofxPixelBufferFileWriter_<T>::run(){
+    vector<char> padding(myHeader.frameStride - myHeader.frameSize, 0);
+    unique_lock<mutex> lock(myMutex);
+    while (true){
+        myCondition.wait(lock, [&](){ return !myQueue.empty() || (bClosing && myPushing == 0); });
+        if (myQueue.empty()){
+            // closing and everything is written
+            return;
+        }
+        int slot = myQueue.front();
+        myQueue.pop_front();
+        bool error = myStats.error;
+        lock.unlock();
+
+        bool success = false;
+        auto t0 = chrono::steady_clock::now();
+        if (!error){
+            success = (fwrite(mySlots[slot].getData(), 1, myHeader.frameSize, myFile) == myHeader.frameSize)
+                && (fwrite(padding.data(), 1, padding.size(), myFile) == padding.size());
+        }
+        double time = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+        lock.lock();
+        if (success){
+            myStats.framesWritten++;
+            myStats.bytesWritten += myHeader.frameStride;
+        } else {
+            if (!error){
+                cout << "couldn't write " << myPath << "!\n";
+            }
+            myStats.error = true;
+            myStats.framesDropped++;
+        }
+        myStats.writeTime += time;
+        myFreeSlots.push_back(slot);
+    }
+}
+
+template<typename T>
+bool ofxPixelBufferFileWriter_<T>::close(){
+    if (!myFile){
+        return false;
+    }
+    // from now on push() drops the frames. the writer thread waits for the frames
+    // which are being pushed right now, writes everything that is queued and returns.
+    {
+        lock_guard<mutex> lock(myMutex);
+        bClosing = true;
+    }
+    myCondition.notify_one();
+    myThread.join();
+
+    // a partial frame after a write error is cut off by the frame count
+    FILE* file = myFile;
+    bool error;
+    {
+        lock_guard<mutex> lock(myMutex);
+        myHeader.numFrames = myStats.framesWritten;
+        error = myStats.error;
+        myFile = nullptr;
+    }
+    bool success = (fseek(file, 0, SEEK_SET) == 0) && ofxPixelBufferWriteFileHeader(file, myHeader);
+    success = (fclose(file) == 0) && success;
+    if (!success){
+        cout << "couldn't write " << myPath << "!\n";
+    }
+    return success && !error;
+}
+
+template<typename T>
+ofxPixelBufferWriterStats ofxPixelBufferFileWriter_<T>::getStats() const {
+    lock_guard<mutex> lock(myMutex);
+    ofxPixelBufferWriterStats stats = myStats;
+    stats.queueDepth = myQueue.size();
+    stats.throughput = stats.writeTime > 0 ? stats.bytesWritten / stats.writeTime : 0.0;
+    return stats;
+}
+
+template class ofxPixelBufferFileWriter_<unsigned char>;
+template class ofxPixelBufferFileWriter_<unsigned short>;
+template class ofxPixelBufferFileWriter_<float>;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxPixelBufferFile.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct ofxPixelBufferWriterStats {
+    uint64_t framesWritten;
+    uint64_t framesDropped; // queue full, wrong dimensions or after a write error
+    uint64_t bytesWritten; // including the padding between frames
+    int queueDepth; // frames waiting to be written
+    int queueCapacity;
+    double writeTime; // total seconds the writer thread spent writing
+    double throughput; // bytesWritten / writeTime (bytes per second)
+    bool error; // a write failed, the rest of the recording is dropped
+};
+
+// appends frames to a raw ofxPixelBuffer file (see ofxPixelBufferFile.h) on a background thread.
+// push() only copies the frame into one of 'queueFrames' preallocated slots and never waits for the disk:
+// if all slots are taken, the frame is dropped. the file can be opened with ofxPixelBuffer::loadMapped
+// or loadStreamed once the writer has been closed.
+template<typename T>
+class ofxPixelBufferFileWriter_ {
+    protected:
+        string myPath;
+        FILE* myFile;
+        ofxPixelBufferFileHeader myHeader;
+        vector<ofPixels_<T>> mySlots;
+        deque<int> myQueue; // slots waiting to be written, oldest first
+        vector<int> myFreeSlots;
+        int myPushing; // slots taken by push() which aren't queued yet
+        ofxPixelBufferWriterStats myStats;
+        bool bClosing;
+        mutable mutex myMutex;
+        condition_variable myCondition;
+        thread myThread;
+
+        void run();
+    public:
+        ofxPixelBufferFileWriter_();
+        ~ofxPixelBufferFileWriter_();
+        ofxPixelBufferFileWriter_(const ofxPixelBufferFileWriter_<T>&) = delete;
+        ofxPixelBufferFileWriter_<T>& operator= (const ofxPixelBufferFileWriter_<T>&) = delete;
+
+        // creates the file and starts the writer thread (closes the previous file)
+        bool open(const string& filePath, int width, int height, int channels, int queueFrames = 16);
+        // false if the frame has been dropped. may be called from several threads.
+        bool push(const ofPixels_<T>& pixels);
+        // waits until the queued frames are written and completes the header
+        bool close();
+        bool isOpen() const {return myFile != nullptr;}
+        const string& getPath() const {return myPath;}
+        int getWidth() const {return myHeader.width;}
+        int getHeight() const {return myHeader.height;}
+        int getNumChannels() const {return myHeader.channels;}
+        ofxPixelBufferWriterStats getStats() const;
+};
+
+typedef ofxPixelBufferFileWriter_<unsigned char> ofxPixelBufferFileWriter;
@@ -0,0 +1,612 @@
+#include "ofxPixelBufferKernels.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OFX_PIXEL_BUFFER_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OFX_PIXEL_BUFFER_SSE2
+#endif
+
+// GCC and Clang need to be told that a function may use AVX2,
+// MSVC always allows the intrinsics.
+#if defined(OFX_PIXEL_BUFFER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define OFX_PIXEL_BUFFER_AVX2
+#define OFX_PIXEL_BUFFER_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(OFX_PIXEL_BUFFER_X86) && defined(_MSC_VER)
+#define OFX_PIXEL_BUFFER_AVX2
+#define OFX_PIXEL_BUFFER_TARGET_AVX2
+#endif
+
+/// lerp kernels
+// the weight is given in 1/256 steps (0 - 256):
+// dst = (src1 * (256 - weight) + src2 * weight + 128) >> 8
+// the sum never exceeds 255 * 256 + 128, so it fits into an unsigned 16-bit lane.
+
+static void lerpScalar(const unsigned char* src1, const unsigned char* src2, unsigned char* dst, size_t size, int weight){
+    int weight1 = 256 - weight;
+    for (size_t i = 0; i < size; ++i){
+        dst[i] = static_cast<unsigned char>((src1[i] * weight1 + src2[i] * weight + 128) >> 8);
+    }
+}
+
+#ifdef OFX_PIXEL_BUFFER_SSE2
+static void lerpSSE2(const unsigned char* src1, const unsigned char* src2, unsigned char* dst, size_t size, int weight){
+    const __m128i w1 = _mm_set1_epi16(static_cast<short>(256 - weight));
+    const __m128i w2 = _mm_set1_epi16(static_cast<short>(weight));
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w1),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w2));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w1),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w2));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    lerpScalar(src1 + i, src2 + i, dst + i, size - i, weight);
+}
+#endif
+
+#ifdef OFX_PIXEL_BUFFER_AVX2
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static void lerpAVX2(const unsigned char* src1, const unsigned char* src2, unsigned char* dst, size_t size, int weight){
+    const __m256i w1 = _mm256_set1_epi16(static_cast<short>(256 - weight));
+    const __m256i w2 = _mm256_set1_epi16(static_cast<short>(weight));
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    // unpack and pack both work per 128-bit lane, so the byte order is preserved.
+    for (; i + 32 <= size; i += 32){
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), w1),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), w2));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), w1),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), w2));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    lerpScalar(src1 + i, src2 + i, dst + i, size - i, weight);
+}
+
+static bool hasAVX2(){
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7){
+        return false;
+    }
+    __cpuid(info, 1);
+    // the OS must save the YMM registers (OSXSAVE + XCR0)
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6){
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+/// 16-bit lerp kernels
+// the weight is given in 1/32768 steps (0 - 32768):
+// dst = (src1 * (32768 - weight) + src2 * weight + 16384) >> 15
+// the sum never exceeds 65535 * 32768 + 16384, so it fits into a signed 32-bit lane.
+
+typedef void (*lerpKernel16)(const unsigned short* src1, const unsigned short* src2, unsigned short* dst, size_t size, int weight);
+
+static void lerp16Scalar(const unsigned short* src1, const unsigned short* src2, unsigned short* dst, size_t size, int weight){
+    int weight1 = 32768 - weight;
+    for (size_t i = 0; i < size; ++i){
+        dst[i] = static_cast<unsigned short>((src1[i] * weight1 + src2[i] * weight + 16384) >> 15);
+    }
+}
+
+#ifdef OFX_PIXEL_BUFFER_SSE2
+// SSE2 has no unsigned 32 -> 16 bit pack, so we pack signed and flip the sign bit
+static inline __m128i packus32SSE2(__m128i lo, __m128i hi){
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(-32768);
+    return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32)), bias16);
+}
+
+// full 32-bit products of unsigned 16-bit values
+static inline void mul16SSE2(__m128i a, __m128i w, __m128i& lo, __m128i& hi){
+    __m128i l = _mm_mullo_epi16(a, w);
+    __m128i h = _mm_mulhi_epu16(a, w);
+    lo = _mm_unpacklo_epi16(l, h);
+    hi = _mm_unpackhi_epi16(l, h);
+}
+
+static void lerp16SSE2(const unsigned short* src1, const unsigned short* src2, unsigned short* dst, size_t size, int weight){
+    const __m128i w1 = _mm_set1_epi16(static_cast<short>(32768 - weight));
+    const __m128i w2 = _mm_set1_epi16(static_cast<short>(weight));
+    const __m128i round = _mm_set1_epi32(16384);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + i));
+        __m128i alo, ahi, blo, bhi;
+        mul16SSE2(a, w1, alo, ahi);
+        mul16SSE2(b, w2, blo, bhi);
+        __m128i lo = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(alo, blo), round), 15);
+        __m128i hi = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(ahi, bhi), round), 15);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packus32SSE2(lo, hi));
+    }
+    lerp16Scalar(src1 + i, src2 + i, dst + i, size - i, weight);
+}
+#endif
+
+#ifdef OFX_PIXEL_BUFFER_AVX2
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static void lerp16AVX2(const unsigned short* src1, const unsigned short* src2, unsigned short* dst, size_t size, int weight){
+    const __m256i w1 = _mm256_set1_epi16(static_cast<short>(32768 - weight));
+    const __m256i w2 = _mm256_set1_epi16(static_cast<short>(weight));
+    const __m256i round = _mm256_set1_epi32(16384);
+    size_t i = 0;
+    // unpack and pack both work per 128-bit lane, so the order is preserved.
+    for (; i + 16 <= size; i += 16){
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + i));
+        __m256i al = _mm256_mullo_epi16(a, w1);
+        __m256i ah = _mm256_mulhi_epu16(a, w1);
+        __m256i bl = _mm256_mullo_epi16(b, w2);
+        __m256i bh = _mm256_mulhi_epu16(b, w2);
+        __m256i lo = _mm256_add_epi32(_mm256_unpacklo_epi16(al, ah), _mm256_unpacklo_epi16(bl, bh));
+        __m256i hi = _mm256_add_epi32(_mm256_unpackhi_epi16(al, ah), _mm256_unpackhi_epi16(bl, bh));
+        lo = _mm256_srli_epi32(_mm256_add_epi32(lo, round), 15);
+        hi = _mm256_srli_epi32(_mm256_add_epi32(hi, round), 15);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi32(lo, hi));
+    }
+    lerp16Scalar(src1 + i, src2 + i, dst + i, size - i, weight);
+}
+#endif
+
+/// float lerp kernels
+// dst = src1 + (src2 - src1) * weight
+
+typedef void (*lerpKernelFloat)(const float* src1, const float* src2, float* dst, size_t size, float weight);
+
+static void lerpFloatScalar(const float* src1, const float* src2, float* dst, size_t size, float weight){
+    for (size_t i = 0; i < size; ++i){
+        dst[i] = src1[i] + (src2[i] - src1[i]) * weight;
+    }
+}
+
+#ifdef OFX_PIXEL_BUFFER_SSE2
+static void lerpFloatSSE2(const float* src1, const float* src2, float* dst, size_t size, float weight){
+    const __m128 w = _mm_set1_ps(weight);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4){
+        __m128 a = _mm_loadu_ps(src1 + i);
+        __m128 b = _mm_loadu_ps(src2 + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), w)));
+    }
+    lerpFloatScalar(src1 + i, src2 + i, dst + i, size - i, weight);
+}
+#endif
+
+#ifdef OFX_PIXEL_BUFFER_AVX2
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static void lerpFloatAVX2(const float* src1, const float* src2, float* dst, size_t size, float weight){
+    const __m256 w = _mm256_set1_ps(weight);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8){
+        __m256 a = _mm256_loadu_ps(src1 + i);
+        __m256 b = _mm256_loadu_ps(src2 + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), w)));
+    }
+    lerpFloatScalar(src1 + i, src2 + i, dst + i, size - i, weight);
+}
+#endif
+
+/// cubic kernels
+// Catmull-Rom over four frames. the weights are given in 1/16384 steps and add up to 16384:
+// dst = (src0 * w0 + src1 * w1 + src2 * w2 + src3 * w3 + 8192) >> 14
+// w0 and w3 are negative (down to -0.0625) and w1 + w2 reaches 1.125, so the result can leave
+// the value range and has to saturate. the sums fit into signed 32-bit lanes even for 16-bit frames.
+// the SIMD versions use madd, which multiplies signed 16-bit values: 16-bit frames are biased by -32768
+// (flipping the sign bit) and the bias is added back after the shift, which works since the weights add up to one.
+
+typedef void (*cubicKernel8)(const unsigned char* src0, const unsigned char* src1, const unsigned char* src2, const unsigned char* src3,
+                             unsigned char* dst, size_t size, const int* weights);
+typedef void (*cubicKernel16)(const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, const unsigned short* src3,
+                              unsigned short* dst, size_t size, const int* weights);
+typedef void (*cubicKernelFloat)(const float* src0, const float* src1, const float* src2, const float* src3,
+                                 float* dst, size_t size, const float* weights);
+
+static void cubicScalar(const unsigned char* src0, const unsigned char* src1, const unsigned char* src2, const unsigned char* src3,
+                        unsigned char* dst, size_t size, const int* w){
+    for (size_t i = 0; i < size; ++i){
+        int sum = src0[i] * w[0] + src1[i] * w[1] + src2[i] * w[2] + src3[i] * w[3] + 8192;
+        dst[i] = sum <= 0 ? 0 : static_cast<unsigned char>(sum >= (256 << 14) ? 255 : sum >> 14);
+    }
+}
+
+static void cubic16Scalar(const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, const unsigned short* src3,
+                          unsigned short* dst, size_t size, const int* w){
+    for (size_t i = 0; i < size; ++i){
+        int sum = src0[i] * w[0] + src1[i] * w[1] + src2[i] * w[2] + src3[i] * w[3] + 8192;
+        dst[i] = sum <= 0 ? 0 : static_cast<unsigned short>(sum >= (65536 << 14) ? 65535 : sum >> 14);
+    }
+}
+
+static void cubicFloatScalar(const float* src0, const float* src1, const float* src2, const float* src3,
+                             float* dst, size_t size, const float* w){
+    for (size_t i = 0; i < size; ++i){
+        dst[i] = src0[i] * w[0] + src1[i] * w[1] + src2[i] * w[2] + src3[i] * w[3];
+    }
+}
+
+// two 16-bit weights in one 32-bit lane, as expected by madd
+static inline int pairWeights(int lo, int hi){
+    return static_cast<int>((static_cast<unsigned int>(hi) << 16) | (static_cast<unsigned int>(lo) & 0xffff));
+}
+
+#ifdef OFX_PIXEL_BUFFER_SSE2
+// 8 signed 16-bit values of each frame -> 8 blended values, saturated to signed 16 bit
+static inline __m128i cubicBlendSSE2(__m128i a, __m128i b, __m128i c, __m128i d, __m128i w01, __m128i w23){
+    const __m128i round = _mm_set1_epi32(8192);
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), w01), _mm_madd_epi16(_mm_unpacklo_epi16(c, d), w23));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), w01), _mm_madd_epi16(_mm_unpackhi_epi16(c, d), w23));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 14);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 14);
+    return _mm_packs_epi32(lo, hi);
+}
+
+static void cubicSSE2(const unsigned char* src0, const unsigned char* src1, const unsigned char* src2, const unsigned char* src3,
+                      unsigned char* dst, size_t size, const int* w){
+    const __m128i w01 = _mm_set1_epi32(pairWeights(w[0], w[1]));
+    const __m128i w23 = _mm_set1_epi32(pairWeights(w[2], w[3]));
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src0 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src3 + i));
+        __m128i lo = cubicBlendSSE2(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero),
+                                    _mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero), w01, w23);
+        __m128i hi = cubicBlendSSE2(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero),
+                                    _mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero), w01, w23);
+        // packus clamps the over- and undershoots to 0 - 255
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    cubicScalar(src0 + i, src1 + i, src2 + i, src3 + i, dst + i, size - i, w);
+}
+
+static void cubic16SSE2(const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, const unsigned short* src3,
+                        unsigned short* dst, size_t size, const int* w){
+    const __m128i w01 = _mm_set1_epi32(pairWeights(w[0], w[1]));
+    const __m128i w23 = _mm_set1_epi32(pairWeights(w[2], w[3]));
+    const __m128i bias = _mm_set1_epi16(-32768);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8){
+        __m128i a = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src0 + i)), bias);
+        __m128i b = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + i)), bias);
+        __m128i c = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + i)), bias);
+        __m128i d = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src3 + i)), bias);
+        // saturating to signed 16 bit and removing the bias clamps to 0 - 65535
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(cubicBlendSSE2(a, b, c, d, w01, w23), bias));
+    }
+    cubic16Scalar(src0 + i, src1 + i, src2 + i, src3 + i, dst + i, size - i, w);
+}
+
+static void cubicFloatSSE2(const float* src0, const float* src1, const float* src2, const float* src3,
+                           float* dst, size_t size, const float* w){
+    const __m128 w0 = _mm_set1_ps(w[0]);
+    const __m128 w1 = _mm_set1_ps(w[1]);
+    const __m128 w2 = _mm_set1_ps(w[2]);
+    const __m128 w3 = _mm_set1_ps(w[3]);
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4){
+        __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src0 + i), w0), _mm_mul_ps(_mm_loadu_ps(src1 + i), w1));
+        sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src2 + i), w2), _mm_mul_ps(_mm_loadu_ps(src3 + i), w3)));
+        _mm_storeu_ps(dst + i, sum);
+    }
+    cubicFloatScalar(src0 + i, src1 + i, src2 + i, src3 + i, dst + i, size - i, w);
+}
+#endif
+
+#ifdef OFX_PIXEL_BUFFER_AVX2
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static inline __m256i cubicBlendAVX2(__m256i a, __m256i b, __m256i c, __m256i d, __m256i w01, __m256i w23){
+    const __m256i round = _mm256_set1_epi32(8192);
+    __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w01), _mm256_madd_epi16(_mm256_unpacklo_epi16(c, d), w23));
+    __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w01), _mm256_madd_epi16(_mm256_unpackhi_epi16(c, d), w23));
+    lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), 14);
+    hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), 14);
+    return _mm256_packs_epi32(lo, hi);
+}
+
+// unpack and pack both work per 128-bit lane, so the order is preserved.
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static void cubicAVX2(const unsigned char* src0, const unsigned char* src1, const unsigned char* src2, const unsigned char* src3,
+                      unsigned char* dst, size_t size, const int* w){
+    const __m256i w01 = _mm256_set1_epi32(pairWeights(w[0], w[1]));
+    const __m256i w23 = _mm256_set1_epi32(pairWeights(w[2], w[3]));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32){
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src0 + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src3 + i));
+        __m256i lo = cubicBlendAVX2(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero),
+                                    _mm256_unpacklo_epi8(c, zero), _mm256_unpacklo_epi8(d, zero), w01, w23);
+        __m256i hi = cubicBlendAVX2(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero),
+                                    _mm256_unpackhi_epi8(c, zero), _mm256_unpackhi_epi8(d, zero), w01, w23);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    cubicScalar(src0 + i, src1 + i, src2 + i, src3 + i, dst + i, size - i, w);
+}
+
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static void cubic16AVX2(const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, const unsigned short* src3,
+                        unsigned short* dst, size_t size, const int* w){
+    const __m256i w01 = _mm256_set1_epi32(pairWeights(w[0], w[1]));
+    const __m256i w23 = _mm256_set1_epi32(pairWeights(w[2], w[3]));
+    const __m256i bias = _mm256_set1_epi16(-32768);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16){
+        __m256i a = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src0 + i)), bias);
+        __m256i b = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i)), bias);
+        __m256i c = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + i)), bias);
+        __m256i d = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src3 + i)), bias);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(cubicBlendAVX2(a, b, c, d, w01, w23), bias));
+    }
+    cubic16Scalar(src0 + i, src1 + i, src2 + i, src3 + i, dst + i, size - i, w);
+}
+
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static void cubicFloatAVX2(const float* src0, const float* src1, const float* src2, const float* src3,
+                           float* dst, size_t size, const float* w){
+    const __m256 w0 = _mm256_set1_ps(w[0]);
+    const __m256 w1 = _mm256_set1_ps(w[1]);
+    const __m256 w2 = _mm256_set1_ps(w[2]);
+    const __m256 w3 = _mm256_set1_ps(w[3]);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8){
+        __m256 sum = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src0 + i), w0), _mm256_mul_ps(_mm256_loadu_ps(src1 + i), w1));
+        sum = _mm256_add_ps(sum, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src2 + i), w2), _mm256_mul_ps(_mm256_loadu_ps(src3 + i), w3)));
+        _mm256_storeu_ps(dst + i, sum);
+    }
+    cubicFloatScalar(src0 + i, src1 + i, src2 + i, src3 + i, dst + i, size - i, w);
+}
+#endif
+
+/// compare kernels
+
+typedef bool (*equalKernel)(const unsigned char* src1, const unsigned char* src2, size_t size);
+
+static bool equalScalar(const unsigned char* src1, const unsigned char* src2, size_t size){
+    return memcmp(src1, src2, size) == 0;
+}
+
+#ifdef OFX_PIXEL_BUFFER_SSE2
+static bool equalSSE2(const unsigned char* src1, const unsigned char* src2, size_t size){
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16){
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src1 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xffff){
+            return false;
+        }
+    }
+    return equalScalar(src1 + i, src2 + i, size - i);
+}
+#endif
+
+#ifdef OFX_PIXEL_BUFFER_AVX2
+OFX_PIXEL_BUFFER_TARGET_AVX2
+static bool equalAVX2(const unsigned char* src1, const unsigned char* src2, size_t size){
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32){
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src1 + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + i));
+        if (static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b))) != 0xffffffffu){
+            return false;
+        }
+    }
+    return equalScalar(src1 + i, src2 + i, size - i);
+}
+#endif
+
+static equalKernel chooseEqualKernel(){
+#ifdef OFX_PIXEL_BUFFER_AVX2
+    if (hasAVX2()){
+        return equalAVX2;
+    }
+#endif
+#ifdef OFX_PIXEL_BUFFER_SSE2
+    return equalSSE2;
+#else
+    return equalScalar;
+#endif
+}
+
+/// kernel tables
+// the wrappers convert the weight and call the kernel directly, so a table entry costs one indirect call.
+
+template<ofxPixelBufferLerpKernel kernel>
+static void lerp8(const unsigned char* src1, const unsigned char* src2, unsigned char* dst, size_t size, float weight){
+    int w = static_cast<int>(weight * 256.f + 0.5f);
+    if (w <= 0){
+        memcpy(dst, src1, size);
+    } else if (w >= 256){
+        memcpy(dst, src2, size);
+    } else {
+        kernel(src1, src2, dst, size, w);
+    }
+}
+
+template<lerpKernel16 kernel>
+static void lerp16(const unsigned short* src1, const unsigned short* src2, unsigned short* dst, size_t size, float weight){
+    int w = static_cast<int>(weight * 32768.f + 0.5f);
+    if (w <= 0){
+        memcpy(dst, src1, size * sizeof(unsigned short));
+    } else if (w >= 32768){
+        memcpy(dst, src2, size * sizeof(unsigned short));
+    } else {
+        kernel(src1, src2, dst, size, w);
+    }
+}
+
+// Catmull-Rom weights of the four frames for a position between the two middle ones
+static void cubicWeights(float t, float* w){
+    float t2 = t * t;
+    float t3 = t2 * t;
+    w[0] = 0.5f * (-t3 + 2.f * t2 - t);
+    w[1] = 0.5f * (3.f * t3 - 5.f * t2 + 2.f);
+    w[2] = 0.5f * (-3.f * t3 + 4.f * t2 + t);
+    w[3] = 0.5f * (t3 - t2);
+}
+
+template<typename T, void (*kernel)(const T*, const T*, const T*, const T*, T*, size_t, const int*)>
+static void cubicFixed(const T* src0, const T* src1, const T* src2, const T* src3, T* dst, size_t size, float weight){
+    float wf[4];
+    cubicWeights(weight, wf);
+    // derive w1 from the others, so the weights add up to exactly 1 and flat areas stay flat
+    int w[4];
+    w[0] = static_cast<int>(lroundf(wf[0] * 16384.f));
+    w[2] = static_cast<int>(lroundf(wf[2] * 16384.f));
+    w[3] = static_cast<int>(lroundf(wf[3] * 16384.f));
+    w[1] = 16384 - w[0] - w[2] - w[3];
+    if (w[0] == 0 && w[2] == 0 && w[3] == 0){
+        memcpy(dst, src1, size * sizeof(T));
+    } else if (w[0] == 0 && w[1] == 0 && w[3] == 0){
+        memcpy(dst, src2, size * sizeof(T));
+    } else {
+        kernel(src0, src1, src2, src3, dst, size, w);
+    }
+}
+
+template<cubicKernelFloat kernel>
+static void cubicFloat(const float* src0, const float* src1, const float* src2, const float* src3, float* dst, size_t size, float weight){
+    float w[4];
+    cubicWeights(weight, w);
+    kernel(src0, src1, src2, src3, dst, size, w);
+}
+
+static ofxPixelBufferKernels<unsigned char> chooseKernels8(){
+#ifdef OFX_PIXEL_BUFFER_AVX2
+    if (hasAVX2()){
+        return {lerp8<lerpAVX2>, cubicFixed<unsigned char, cubicAVX2>, "avx2", 256};
+    }
+#endif
+#ifdef OFX_PIXEL_BUFFER_SSE2
+    return {lerp8<lerpSSE2>, cubicFixed<unsigned char, cubicSSE2>, "sse2", 256};
+#else
+    return {lerp8<lerpScalar>, cubicFixed<unsigned char, cubicScalar>, "scalar", 256};
+#endif
+}
+
+static ofxPixelBufferKernels<unsigned short> chooseKernels16(){
+#ifdef OFX_PIXEL_BUFFER_AVX2
+    if (hasAVX2()){
+        return {lerp16<lerp16AVX2>, cubicFixed<unsigned short, cubic16AVX2>, "avx2", 32768};
+    }
+#endif
+#ifdef OFX_PIXEL_BUFFER_SSE2
+    return {lerp16<lerp16SSE2>, cubicFixed<unsigned short, cubic16SSE2>, "sse2", 32768};
+#else
+    return {lerp16<lerp16Scalar>, cubicFixed<unsigned short, cubic16Scalar>, "scalar", 32768};
+#endif
+}
+
+static ofxPixelBufferKernels<float> chooseKernelsFloat(){
+#ifdef OFX_PIXEL_BUFFER_AVX2
+    if (hasAVX2()){
+        return {lerpFloatAVX2, cubicFloat<cubicFloatAVX2>, "avx2", 0};
+    }
+#endif
+#ifdef OFX_PIXEL_BUFFER_SSE2
+    return {lerpFloatSSE2, cubicFloat<cubicFloatSSE2>, "sse2", 0};
+#else
+    return {lerpFloatScalar, cubicFloat<cubicFloatScalar>, "scalar", 0};
+#endif
+}
+
+template<>
+const ofxPixelBufferKernels<unsigned char>& ofxPixelBufferGetKernels<unsigned char>(){
+    static const ofxPixelBufferKernels<unsigned char> kernels = chooseKernels8();
+    return kernels;
+}
+
+template<>
+const ofxPixelBufferKernels<unsigned short>& ofxPixelBufferGetKernels<unsigned short>(){
+    static const ofxPixelBufferKernels<unsigned short> kernels = chooseKernels16();
+    return kernels;
+}
+
+template<>
+const ofxPixelBufferKernels<float>& ofxPixelBufferGetKernels<float>(){
+    static const ofxPixelBufferKernels<float> kernels = chooseKernelsFloat();
+    return kernels;
+}
+
+ofxPixelBufferLerpKernel ofxPixelBufferGetLerpKernel(const char* name){
+    if (!strcmp(name, "scalar")){
+        return lerpScalar;
+    }
+#ifdef OFX_PIXEL_BUFFER_SSE2
+    if (!strcmp(name, "sse2")){
+        return lerpSSE2;
+    }
+#endif
+#ifdef OFX_PIXEL_BUFFER_AVX2
+    if (!strcmp(name, "avx2") && hasAVX2()){
+        return lerpAVX2;
+    }
+#endif
+    return nullptr;
+}
+
+void ofxPixelBufferLerp(const unsigned char* src1, const unsigned char* src2, unsigned char* dst, size_t size, float weight){
+    ofxPixelBufferGetKernels<unsigned char>().lerp(src1, src2, dst, size, weight);
+}
+
+void ofxPixelBufferLerp(const unsigned short* src1, const unsigned short* src2, unsigned short* dst, size_t size, float weight){
+    ofxPixelBufferGetKernels<unsigned short>().lerp(src1, src2, dst, size, weight);
+}
+
+void ofxPixelBufferLerp(const float* src1, const float* src2, float* dst, size_t size, float weight){
+    ofxPixelBufferGetKernels<float>().lerp(src1, src2, dst, size, weight);
+}
+
+void ofxPixelBufferCubic(const unsigned char* src0, const unsigned char* src1, const unsigned char* src2, const unsigned char* src3,
+                         unsigned char* dst, size_t size, float weight){
+    ofxPixelBufferGetKernels<unsigned char>().cubic(src0, src1, src2, src3, dst, size, weight);
+}
+
+void ofxPixelBufferCubic(const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, const unsigned short* src3,
+                         unsigned short* dst, size_t size, float weight){
+    ofxPixelBufferGetKernels<unsigned short>().cubic(src0, src1, src2, src3, dst, size, weight);
+}
+
+void ofxPixelBufferCubic(const float* src0, const float* src1, const float* src2, const float* src3,
+                         float* dst, size_t size, float weight){
+    ofxPixelBufferGetKernels<float>().cubic(src0, src1, src2, src3, dst, size, weight);
+}
+
+bool ofxPixelBufferEqual(const unsigned char* src1, const unsigned char* src2, size_t size){
+    static const equalKernel kernel = chooseEqualKernel();
+    return kernel(src1, src2, size);
+}
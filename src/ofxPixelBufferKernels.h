@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+/// pixel kernels used by the ofxPixelBuffer classes
+
+// blend two 8-bit frames: dst = src1 * (1 - weight) + src2 * weight, with weight in [0, 1].
+// uses 8-bit fixed-point weights, so the result can differ by 1 from a float blend.
+// the fastest available implementation (AVX2, SSE2 or scalar) is picked at runtime.
+void ofxPixelBufferLerp(const unsigned char* src1, const unsigned char* src2, unsigned char* dst, size_t size, float weight);
+// 16-bit frames use 15-bit fixed-point weights, float frames are blended directly.
+// 'size' is the number of values (not bytes).
+void ofxPixelBufferLerp(const unsigned short* src1, const unsigned short* src2, unsigned short* dst, size_t size, float weight);
+void ofxPixelBufferLerp(const float* src1, const float* src2, float* dst, size_t size, float weight);
+
+// Catmull-Rom interpolation between src1 and src2, using src0 and src3 as the outer neighbours.
+// 'weight' is the position between src1 (0) and src2 (1). integer frames use 14-bit fixed-point
+// weights and saturate, since the curve can overshoot. float frames are not clamped.
+void ofxPixelBufferCubic(const unsigned char* src0, const unsigned char* src1, const unsigned char* src2, const unsigned char* src3,
+                         unsigned char* dst, size_t size, float weight);
+void ofxPixelBufferCubic(const unsigned short* src0, const unsigned short* src1, const unsigned short* src2, const unsigned short* src3,
+                         unsigned short* dst, size_t size, float weight);
+void ofxPixelBufferCubic(const float* src0, const float* src1, const float* src2, const float* src3,
+                         float* dst, size_t size, float weight);
+
+// the individual implementations (nullptr if not available on this platform/CPU)
+typedef void (*ofxPixelBufferLerpKernel)(const unsigned char* src1, const unsigned char* src2, unsigned char* dst, size_t size, int weight);
+ofxPixelBufferLerpKernel ofxPixelBufferGetLerpKernel(const char* name); // "scalar", "sse2" or "avx2"
+
+// the kernels of one pixel type, resolved once for this CPU.
+// every ofxPixelBuffer_ picks them up when it is created, so reading doesn't dispatch per call.
+// the frames are processed as flat arrays of values, so the same kernels serve every channel count.
+template<typename T>
+struct ofxPixelBufferKernels {
+    void (*lerp)(const T* src1, const T* src2, T* dst, size_t size, float weight);
+    void (*cubic)(const T* src0, const T* src1, const T* src2, const T* src3, T* dst, size_t size, float weight);
+    const char* name; // "scalar", "sse2" or "avx2"
+    // lerp rounds the weight to 1/lerpSteps (0 = exact). a weight that rounds to 0 or 1
+    // returns one of the frames unchanged.
+    int lerpSteps;
+};
+
+template<typename T> const ofxPixelBufferKernels<T>& ofxPixelBufferGetKernels();
+template<> const ofxPixelBufferKernels<unsigned char>& ofxPixelBufferGetKernels<unsigned char>();
+template<> const ofxPixelBufferKernels<unsigned short>& ofxPixelBufferGetKernels<unsigned short>();
+template<> const ofxPixelBufferKernels<float>& ofxPixelBufferGetKernels<float>();
+
+// true if both blocks hold the same bytes. stops at the first 16/32 byte block that differs.
+bool ofxPixelBufferEqual(const unsigned char* src1, const unsigned char* src2, size_t size);
@@ -0,0 +1,126 @@
+#include "ofxPixelBufferPlayerGroup.h"
+
+template<typename T>
+ofxPixelBufferPlayerGroup_<T>::ofxPixelBufferPlayerGroup_(int quantization){
+    myQuantization = max(0, quantization);
+    myNumRequests = 0;
+}
+
+template<typename T>
+void ofxPixelBufferPlayerGroup_<T>::add(ofxPixelBufferPlayer_<T>& player){
+    if (find(myPlayers.begin(), myPlayers.end(), &player) == myPlayers.end()){
+        myPlayers.push_back(&player);
+    }
+}
+
+template<typename T>
+void ofxPixelBufferPlayerGroup_<T>::remove(ofxPixelBufferPlayer_<T>& player){
+    auto it = find(myPlayers.begin(), myPlayers.end(), &player);
+    if (it != myPlayers.end()){
+        myPlayers.erase(it);
+        // keep the current frame until the player blends its next one
+        if (player.mySharedPixels){
+            player.lerpPixels = *player.mySharedPixels;
+            player.mySharedPixels.reset();
+            player.mySourceFrame = -1;
+            player.myBlendKey = player.mySharedKey;
+        }
+    }
+}
+
+template<typename T>
+void ofxPixelBufferPlayerGroup_<T>::clear(){
+    while (!myPlayers.empty()){
+        remove(*myPlayers.back());
+    }
+    myEntries.clear();
+    mySpare.clear();
+}
+
+template<typename T>
+shared_ptr<ofPixels_<T>> ofxPixelBufferPlayerGroup_<T>::newFrame(){
+    if (!mySpare.empty()){
+        shared_ptr<ofPixels_<T>> pixels = move(mySpare.back());
+        mySpare.pop_back();
+        return pixels;
+    }
+    return make_shared<ofPixels_<T>>();
+}
+
+template<typename T>
+void ofxPixelBufferPlayerGroup_<T>::update(){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_UPDATE);
+    blend([](ofxPixelBufferPlayer_<T>* player){
+        return player->advance();
+    });
+}
+
+template<typename T>
+void ofxPixelBufferPlayerGroup_<T>::update(double dt){
+    OFX_PIXEL_BUFFER_TIME(myCounters, OFX_PIXEL_BUFFER_OP_UPDATE);
+    blend([dt](ofxPixelBufferPlayer_<T>* player){
+        return player->advance(dt);
+    });
+}
+
+template<typename T>
+void ofxPixelBufferPlayerGroup_<T>::blend(const function<bool(ofxPixelBufferPlayer_<T>*)>& advance){
+    // players which don't move (e.g. paused) keep their frame
+    myMoved.clear();
+    for (auto player : myPlayers){
+        if (advance(player)){
+            player->mySharedPixels.reset();
+            myMoved.push_back(player);
+        }
+    }
+    // the frames of the last update can be reused once no player holds on to them.
+    // (blending into them reuses their memory if the dimensions match)
+    for (auto& entry : myEntries){
+        if (entry.pixels.use_count() == 1){
+            mySpare.push_back(move(entry.pixels));
+        }
+    }
+    myEntries.clear();
+    myNumRequests = myMoved.size();
+
+    for (auto player : myMoved){
+        // integer positions hand out the frame itself
+        int frame;
+        float weight;
+        player->mySourceFrame = player->findSourceFrame(frame, weight);
+        if (player->mySourceFrame >= 0){
+            continue;
+        }
+        const ofxPixelBuffer_<T>* buffer = player->myBufferPtr;
+        ofxPixelBufferInterpolation mode = player->myInterpolation;
+        float position = player->myPosition;
+        if (myQuantization > 0){
+            position = roundf(position * myQuantization) / myQuantization;
+        }
+        // dozens of players, so a linear search is fine
+        auto it = find_if(myEntries.begin(), myEntries.end(), [&](const Entry& entry){
+            return entry.buffer == buffer && entry.mode == mode && entry.position == position;
+        });
+        if (it == myEntries.end()){
+            Entry entry;
+            entry.buffer = buffer;
+            entry.mode = mode;
+            entry.position = position;
+            entry.key = player->getBlendKey(position);
+            entry.pixels = newFrame();
+            if (mode == OFX_PIXEL_BUFFER_INTERPOLATION_CUBIC){
+                buffer->readCubicInto(position, *entry.pixels);
+            } else {
+                buffer->readLinearInto(position, *entry.pixels);
+            }
+            myEntries.push_back(move(entry));
+            it = myEntries.end() - 1;
+        }
+        player->mySharedPixels = it->pixels;
+        player->mySharedKey = it->key;
+    }
+}
+
+template class ofxPixelBufferPlayerGroup_<unsigned char>;
+template class ofxPixelBufferPlayerGroup_<unsigned short>;
+template class ofxPixelBufferPlayerGroup_<float>;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ofxPixelBuffer.h"
+
+// updates many players in one pass. players which interpolate the same buffer at (nearly) the same
+// position share one frame, so every distinct position is only blended once per update.
+// the players must outlive their membership (remove them before destroying them).
+template<typename T>
+class ofxPixelBufferPlayerGroup_ {
+    protected:
+        struct Entry {
+            const ofxPixelBuffer_<T>* buffer;
+            ofxPixelBufferInterpolation mode;
+            float position; // quantized
+            typename ofxPixelBufferPlayer_<T>::BlendKey key; // what the frame has been blended from
+            shared_ptr<ofPixels_<T>> pixels;
+        };
+        vector<ofxPixelBufferPlayer_<T>*> myPlayers;
+        vector<ofxPixelBufferPlayer_<T>*> myMoved; // players which need a new frame in this update
+        vector<Entry> myEntries; // frames blended in the last update
+        vector<shared_ptr<ofPixels_<T>>> mySpare; // recycled frames
+        int myQuantization;
+        int myNumRequests;
+        ofxPixelBufferCounters myCounters;
+
+        shared_ptr<ofPixels_<T>> newFrame();
+        // move every player with 'advance', then blend the distinct positions
+        void blend(const function<bool(ofxPixelBufferPlayer_<T>*)>& advance);
+    public:
+        ofxPixelBufferPlayerGroup_(int quantization = 256);
+
+        void add(ofxPixelBufferPlayer_<T>& player);
+        void remove(ofxPixelBufferPlayer_<T>& player); // the player blends on its own again
+        void clear();
+        int size() const {return myPlayers.size();}
+
+        // positions are rounded to 1/steps of a frame before blending (default: 256, the resolution
+        // of the 8-bit blend weights). 0 = only share exactly the same position.
+        void setQuantization(int steps) {myQuantization = max(0, steps);}
+        int getQuantization() const {return myQuantization;}
+
+        // calls update() on all players. getPixels() of an interpolating player then returns
+        // a frame which is shared read-only with the other players at the same position.
+        void update();
+        void update(double dt); // see ofxPixelBufferPlayer::update(double)
+        int getNumRequests() const {return myNumRequests;} // interpolated frames asked for in the last update
+        int getNumBlends() const {return myEntries.size();} // ... and actually blended
+
+        // timings of update() (only recorded if compiled with OFX_PIXEL_BUFFER_STATS)
+        ofxPixelBufferStats getStats() const {return myCounters.getStats();}
+        void resetStats() {myCounters.reset();}
+};
+
+typedef ofxPixelBufferPlayerGroup_<unsigned char> ofxPixelBufferPlayerGroup;
+typedef ofxPixelBufferPlayerGroup_<unsigned short> ofxShortPixelBufferPlayerGroup;
+typedef ofxPixelBufferPlayerGroup_<float> ofxFloatPixelBufferPlayerGroup;
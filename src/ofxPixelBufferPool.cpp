@@ -0,0 +1,105 @@
+#include "ofxPixelBufferPool.h"
+
+template<typename T>
+ofxPixelBufferFramePool_<T>::ofxPixelBufferFramePool_(int capacity){
+    myWidth = 0;
+    myHeight = 0;
+    myChannels = 0;
+    myCapacity = max(0, capacity);
+    myStats = ofxPixelBufferPoolStats();
+}
+
+template<typename T>
+ofPixels_<T> ofxPixelBufferFramePool_<T>::acquire(int width, int height, int channels, bool* allocated){
+    ofPixels_<T> frame;
+    if (allocated){
+        *allocated = false;
+    }
+    {
+        lock_guard<mutex> lock(myMutex);
+        if (width != myWidth || height != myHeight || channels != myChannels){
+            myStats.discards += myFrames.size();
+            myFrames.clear();
+            myWidth = width;
+            myHeight = height;
+            myChannels = channels;
+        }
+        if (!myFrames.empty()){
+            frame = move(myFrames.back());
+            myFrames.pop_back();
+            myStats.reuses++;
+            return frame;
+        }
+        myStats.allocations++;
+    }
+    if (allocated){
+        *allocated = true;
+    }
+    // allocate outside the lock
+    frame.allocate(width, height, channels);
+    return frame;
+}
+
+template<typename T>
+void ofxPixelBufferFramePool_<T>::release(ofPixels_<T>&& frame){
+    if (!frame.isAllocated()){
+        return;
+    }
+    lock_guard<mutex> lock(myMutex);
+    if ((int)myFrames.size() < myCapacity && (int)frame.getWidth() == myWidth
+            && (int)frame.getHeight() == myHeight && (int)frame.getNumChannels() == myChannels){
+        myFrames.push_back(move(frame));
+        myStats.returns++;
+    } else {
+        myStats.discards++;
+    }
+    frame.clear();
+}
+
+template<typename T>
+void ofxPixelBufferFramePool_<T>::setCapacity(int frames){
+    lock_guard<mutex> lock(myMutex);
+    myCapacity = max(0, frames);
+    if ((int)myFrames.size() > myCapacity){
+        myStats.discards += myFrames.size() - myCapacity;
+        myFrames.resize(myCapacity);
+    }
+}
+
+template<typename T>
+int ofxPixelBufferFramePool_<T>::getCapacity() const {
+    lock_guard<mutex> lock(myMutex);
+    return myCapacity;
+}
+
+template<typename T>
+int ofxPixelBufferFramePool_<T>::size() const {
+    lock_guard<mutex> lock(myMutex);
+    return myFrames.size();
+}
+
+template<typename T>
+void ofxPixelBufferFramePool_<T>::clear(){
+    lock_guard<mutex> lock(myMutex);
+    myStats.discards += myFrames.size();
+    myFrames.clear();
+}
+
+template<typename T>
+ofxPixelBufferPoolStats ofxPixelBufferFramePool_<T>::getStats() const {
+    lock_guard<mutex> lock(myMutex);
+    ofxPixelBufferPoolStats stats = myStats;
+    stats.frames = myFrames.size();
+    stats.capacity = myCapacity;
+    return stats;
+}
+
+template<typename T>
+void ofxPixelBufferFramePool_<T>::resetStats(){
+    lock_guard<mutex> lock(myMutex);
+    myStats = ofxPixelBufferPoolStats();
+}
+
+template class ofxPixelBufferFramePool_<unsigned char>;
+template class ofxPixelBufferFramePool_<unsigned short>;
+template class ofxPixelBufferFramePool_<float>;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <mutex>
+
+struct ofxPixelBufferPoolStats {
+    uint64_t allocations; // frames that had to be allocated
+    uint64_t reuses; // frames taken from the pool (= allocations avoided)
+    uint64_t returns; // frames given back to the pool
+    uint64_t discards; // frames freed because the pool was full or had other dimensions
+    int frames; // frames currently in the pool
+    int capacity;
+};
+
+// recycles frames of one size, so a buffer used as a sliding window doesn't allocate and free
+// a frame on every push / pop. at most 'capacity' frames are kept, the rest is freed.
+// a pool can be shared by several buffers (also across threads).
+template<typename T>
+class ofxPixelBufferFramePool_ {
+    protected:
+        vector<ofPixels_<T>> myFrames;
+        int myWidth;
+        int myHeight;
+        int myChannels;
+        int myCapacity;
+        ofxPixelBufferPoolStats myStats;
+        mutable mutex myMutex;
+    public:
+        ofxPixelBufferFramePool_(int capacity = 4);
+        ofxPixelBufferFramePool_(const ofxPixelBufferFramePool_<T>&) = delete;
+        ofxPixelBufferFramePool_<T>& operator= (const ofxPixelBufferFramePool_<T>&) = delete;
+
+        // a recycled frame if there is one, otherwise a new one. the pixels are not cleared!
+        // asking for other dimensions than before empties the pool.
+        // 'allocated' (optional) tells if the frame is a new one.
+        ofPixels_<T> acquire(int width, int height, int channels, bool* allocated = nullptr);
+        // only give back frames which own their memory (no views into a slab or a file mapping)
+        void release(ofPixels_<T>&& frame);
+        // high-water mark in frames (0 = don't keep any frames)
+        void setCapacity(int frames);
+        int getCapacity() const;
+        int size() const;
+        void clear();
+        ofxPixelBufferPoolStats getStats() const;
+        void resetStats();
+};
+
+typedef ofxPixelBufferFramePool_<unsigned char> ofxPixelBufferFramePool;
@@ -0,0 +1,90 @@
+#include "ofxPixelBufferStats.h"
+
+double ofxPixelBufferStats::getMeanTime(ofxPixelBufferOp op) const {
+    const ofxPixelBufferOpStats& stats = ops[op];
+    return stats.calls > 0 ? stats.totalTime / stats.calls : 0.0;
+}
+
+double ofxPixelBufferStats::getPercentile(ofxPixelBufferOp op, float fraction) const {
+    const ofxPixelBufferOpStats& stats = ops[op];
+    if (stats.calls == 0){
+        return 0.0;
+    }
+    uint64_t target = (uint64_t)ceil(max(0.f, min(1.f, fraction)) * stats.calls);
+    uint64_t count = 0;
+    for (int i = 0; i < ofxPixelBufferHistogramSize - 1; ++i){
+        count += stats.histogram[i];
+        if (count >= max<uint64_t>(1, target)){
+            // the upper bound of the bucket, but never more than the slowest call
+            return min(stats.maxTime, ldexp(1e-6, i));
+        }
+    }
+    return stats.maxTime;
+}
+
+ofxPixelBufferStats& ofxPixelBufferStats::operator+= (const ofxPixelBufferStats& other){
+    enabled = enabled || other.enabled;
+    bytesCopied += other.bytesCopied;
+    frameAllocations += other.frameAllocations;
+    lerpCalls += other.lerpCalls;
+    for (int i = 0; i < OFX_PIXEL_BUFFER_NUM_OPS; ++i){
+        ops[i].calls += other.ops[i].calls;
+        ops[i].totalTime += other.ops[i].totalTime;
+        ops[i].maxTime = max(ops[i].maxTime, other.ops[i].maxTime);
+        for (int j = 0; j < ofxPixelBufferHistogramSize; ++j){
+            ops[i].histogram[j] += other.ops[i].histogram[j];
+        }
+    }
+    return *this;
+}
+
+void ofxPixelBufferCounters::addTime(ofxPixelBufferOp op, uint64_t nanos){
+    Op& stats = myOps[op];
+    stats.calls.fetch_add(1, memory_order_relaxed);
+    stats.nanos.fetch_add(nanos, memory_order_relaxed);
+    uint64_t maxNanos = stats.maxNanos.load(memory_order_relaxed);
+    while (nanos > maxNanos && !stats.maxNanos.compare_exchange_weak(maxNanos, nanos, memory_order_relaxed)){
+    }
+    // log2 of the microseconds
+    int bucket = 0;
+    for (uint64_t micros = nanos / 1000; micros > 0 && bucket < ofxPixelBufferHistogramSize - 1; micros >>= 1){
+        bucket++;
+    }
+    stats.histogram[bucket].fetch_add(1, memory_order_relaxed);
+}
+
+ofxPixelBufferStats ofxPixelBufferCounters::getStats() const {
+    ofxPixelBufferStats stats;
+#ifdef OFX_PIXEL_BUFFER_STATS
+    stats.enabled = true;
+#else
+    stats.enabled = false;
+#endif
+    stats.bytesCopied = myBytes.load(memory_order_relaxed);
+    stats.frameAllocations = myAllocations.load(memory_order_relaxed);
+    stats.lerpCalls = myLerps.load(memory_order_relaxed);
+    for (int i = 0; i < OFX_PIXEL_BUFFER_NUM_OPS; ++i){
+        const Op& op = myOps[i];
+        stats.ops[i].calls = op.calls.load(memory_order_relaxed);
+        stats.ops[i].totalTime = op.nanos.load(memory_order_relaxed) * 1e-9;
+        stats.ops[i].maxTime = op.maxNanos.load(memory_order_relaxed) * 1e-9;
+        for (int j = 0; j < ofxPixelBufferHistogramSize; ++j){
+            stats.ops[i].histogram[j] = op.histogram[j].load(memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+void ofxPixelBufferCounters::reset(){
+    myBytes = 0;
+    myAllocations = 0;
+    myLerps = 0;
+    for (auto& op : myOps){
+        op.calls = 0;
+        op.nanos = 0;
+        op.maxNanos = 0;
+        for (auto& bucket : op.histogram){
+            bucket = 0;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include <atomic>
+#include <chrono>
+
+// instrumentation of the hot paths. it is compiled out unless OFX_PIXEL_BUFFER_STATS is defined
+// (e.g. ADDON_CFLAGS = -DOFX_PIXEL_BUFFER_STATS), otherwise getStats() only returns zeros.
+
+enum ofxPixelBufferOp {
+    OFX_PIXEL_BUFFER_OP_WRITE, // ofxPixelBuffer::write
+    OFX_PIXEL_BUFFER_OP_READ_LINEAR, // readLinear / readLinearInto
+    OFX_PIXEL_BUFFER_OP_READ_CUBIC, // readCubic / readCubicInto
+    OFX_PIXEL_BUFFER_OP_IN, // ofxPixelRingBuffer::in, ofxPixelBufferRecorder::in
+    OFX_PIXEL_BUFFER_OP_UPDATE, // ofxPixelBufferPlayer::update
+    OFX_PIXEL_BUFFER_NUM_OPS
+};
+
+// bucket 0 counts calls below 1 us, bucket i calls between 2^(i-1) and 2^i us,
+// the last bucket everything from ~4 s upwards.
+static const int ofxPixelBufferHistogramSize = 24;
+
+struct ofxPixelBufferOpStats {
+    uint64_t calls;
+    double totalTime; // seconds
+    double maxTime; // seconds
+    uint64_t histogram[ofxPixelBufferHistogramSize];
+};
+
+struct ofxPixelBufferStats {
+    bool enabled; // false if compiled without OFX_PIXEL_BUFFER_STATS
+    uint64_t bytesCopied; // pixel data copied with memcpy (not counting blends and encoding)
+    uint64_t frameAllocations; // frames or slab slots that had to be allocated (not recycled)
+    uint64_t lerpCalls; // linear and cubic blends
+    ofxPixelBufferOpStats ops[OFX_PIXEL_BUFFER_NUM_OPS];
+
+    double getMeanTime(ofxPixelBufferOp op) const;
+    // upper bound of the latency 'fraction' (0 - 1) of the calls stayed below, in seconds.
+    // as precise as the histogram: within a factor of 2.
+    double getPercentile(ofxPixelBufferOp op, float fraction) const;
+    // sums the counters, keeps the larger maximum
+    ofxPixelBufferStats& operator+= (const ofxPixelBufferStats& other);
+};
+
+// the counters behind getStats(). everything is atomic, so producer and consumer
+// threads can record into the same object. copies start from zero.
+class ofxPixelBufferCounters {
+    protected:
+        struct Op {
+            atomic<uint64_t> calls;
+            atomic<uint64_t> nanos;
+            atomic<uint64_t> maxNanos;
+            atomic<uint64_t> histogram[ofxPixelBufferHistogramSize];
+        };
+        atomic<uint64_t> myBytes;
+        atomic<uint64_t> myAllocations;
+        atomic<uint64_t> myLerps;
+        Op myOps[OFX_PIXEL_BUFFER_NUM_OPS];
+    public:
+        ofxPixelBufferCounters() {reset();}
+        ofxPixelBufferCounters(const ofxPixelBufferCounters&) {reset();}
+        ofxPixelBufferCounters& operator= (const ofxPixelBufferCounters&) {return *this;}
+
+        void addBytes(uint64_t bytes) {myBytes.fetch_add(bytes, memory_order_relaxed);}
+        void addAllocations(uint64_t frames) {myAllocations.fetch_add(frames, memory_order_relaxed);}
+        void addLerp() {myLerps.fetch_add(1, memory_order_relaxed);}
+        void addTime(ofxPixelBufferOp op, uint64_t nanos);
+        ofxPixelBufferStats getStats() const;
+        void reset();
+
+        // times its own lifetime
+        class Timer {
+            protected:
+                ofxPixelBufferCounters& myCounters;
+                ofxPixelBufferOp myOp;
+                chrono::steady_clock::time_point myStart;
+            public:
+                Timer(ofxPixelBufferCounters& counters, ofxPixelBufferOp op)
+                    : myCounters(counters), myOp(op), myStart(chrono::steady_clock::now()) {}
+                ~Timer() {
+                    auto nanos = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - myStart).count();
+                    myCounters.addTime(myOp, nanos);
+                }
+        };
+};
+
+#ifdef OFX_PIXEL_BUFFER_STATS
+#define OFX_PIXEL_BUFFER_COUNT_BYTES(counters, bytes) (counters).addBytes(bytes)
+#define OFX_PIXEL_BUFFER_COUNT_ALLOCATIONS(counters, frames) (counters).addAllocations(frames)
+#define OFX_PIXEL_BUFFER_COUNT_LERP(counters) (counters).addLerp()
+#define OFX_PIXEL_BUFFER_TIME(counters, op) ofxPixelBufferCounters::Timer ofxPixelBufferTimer_((counters), (op))
+#else
+#define OFX_PIXEL_BUFFER_COUNT_BYTES(counters, bytes) ((void)0)
+#define OFX_PIXEL_BUFFER_COUNT_ALLOCATIONS(counters, frames) ((void)0)
+#define OFX_PIXEL_BUFFER_COUNT_LERP(counters) ((void)0)
+#define OFX_PIXEL_BUFFER_TIME(counters, op) ((void)0)
+#endif
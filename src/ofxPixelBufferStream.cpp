@@ -0,0 +1,296 @@
+#include "ofxPixelBufferStream.h"
+
+static bool seekFile(FILE* file, uint64_t offset){
+#ifdef TARGET_WIN32
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, offset, SEEK_SET) == 0;
+#endif
+}
+
+static uint64_t getFileSize(FILE* file){
+#ifdef TARGET_WIN32
+    if (_fseeki64(file, 0, SEEK_END) != 0){
+        return 0;
+    }
+    int64_t size = _ftelli64(file);
+#else
+    if (fseeko(file, 0, SEEK_END) != 0){
+        return 0;
+    }
+    int64_t size = ftello(file);
+#endif
+    return size > 0 ? size : 0;
+}
+
+template<typename T>
+ofxPixelBufferStream_<T>::ofxPixelBufferStream_(){
+    myReaderFile = nullptr;
+    myPrefetchFile = nullptr;
+    myPinIndex = 0;
+    myClock = 0;
+    bQuit = false;
+    for (int i = 0; i < numPins; ++i){
+        myPins[i] = -1;
+    }
+    resetStats();
+}
+
+template<typename T>
+ofxPixelBufferStream_<T>::~ofxPixelBufferStream_(){
+    close();
+}
+
+template<typename T>
+bool ofxPixelBufferStream_<T>::open(const string& filePath, int cacheFrames){
+    close();
+
+    myReaderFile = fopen(filePath.c_str(), "rb");
+    if (!myReaderFile){
+        return false;
+    }
+    if (!ofxPixelBufferReadFileHeader(myReaderFile, myHeader) || myHeader.bytesPerChannel != sizeof(T)
+            || !myHeader.fitsInto(getFileSize(myReaderFile))){
+        close();
+        return false;
+    }
+    myPrefetchFile = fopen(filePath.c_str(), "rb");
+    if (!myPrefetchFile){
+        close();
+        return false;
+    }
+    myPath = filePath;
+
+    // the pinned frames and at least a few more must fit into the cache
+    cacheFrames = max(2 * numPins, cacheFrames);
+    mySlots.resize(cacheFrames);
+    for (auto& slot : mySlots){
+        slot.pixels.allocate(myHeader.width, myHeader.height, myHeader.channels);
+        slot.frame = -1;
+        slot.lastUse = 0;
+        slot.loading = false;
+    }
+    resetStats();
+
+    bQuit = false;
+    myThread = thread(&ofxPixelBufferStream_<T>::threadFunction, this);
+    return true;
+}
+
+template<typename T>
+void ofxPixelBufferStream_<T>::close(){
+    if (myThread.joinable()){
+        {
+            lock_guard<mutex> lock(myMutex);
+            bQuit = true;
+        }
+        myRequestCondition.notify_all();
+        myThread.join();
+    }
+    if (myReaderFile){
+        fclose(myReaderFile);
+        myReaderFile = nullptr;
+    }
+    if (myPrefetchFile){
+        fclose(myPrefetchFile);
+        myPrefetchFile = nullptr;
+    }
+    mySlots.clear();
+    myFrameSlots.clear();
+    myRequests.clear();
+    myWanted.clear();
+    for (int i = 0; i < numPins; ++i){
+        myPins[i] = -1;
+    }
+    myPath.clear();
+    myHeader = ofxPixelBufferFileHeader();
+}
+
+template<typename T>
+bool ofxPixelBufferStream_<T>::isPinned(int frame) const {
+    for (int i = 0; i < numPins; ++i){
+        if (myPins[i] == frame){
+            return true;
+        }
+    }
+    return false;
+}
+
+// least recently used slot that may be replaced (-1 if none).
+// the prefetch thread must not evict frames it has been asked for.
+template<typename T>
+int ofxPixelBufferStream_<T>::findVictim(bool prefetching) const {
+    int victim = -1;
+    int wantedVictim = -1;
+    for (int i = 0; i < static_cast<int>(mySlots.size()); ++i){
+        const Slot& slot = mySlots[i];
+        if (slot.frame < 0 && !slot.loading){
+            return i; // empty slot
+        }
+        if (slot.loading || isPinned(slot.frame)){
+            continue;
+        }
+        if (myWanted.count(slot.frame)){
+            if (wantedVictim < 0 || slot.lastUse < mySlots[wantedVictim].lastUse){
+                wantedVictim = i;
+            }
+        } else if (victim < 0 || slot.lastUse < mySlots[victim].lastUse){
+            victim = i;
+        }
+    }
+    return (victim >= 0 || prefetching) ? victim : wantedVictim;
+}
+
+template<typename T>
+void ofxPixelBufferStream_<T>::assignSlot(int slot, int frame){
+    Slot& s = mySlots[slot];
+    if (s.frame >= 0){
+        myFrameSlots.erase(s.frame);
+        myStats.evictions++;
+    }
+    s.frame = frame;
+    s.loading = true;
+    myFrameSlots[frame] = slot;
+}
+
+template<typename T>
+void ofxPixelBufferStream_<T>::touch(int slot){
+    mySlots[slot].lastUse = ++myClock;
+}
+
+template<typename T>
+bool ofxPixelBufferStream_<T>::readFrame(FILE* file, int frame, ofPixels_<T>& pixels) const {
+    if (!seekFile(file, myHeader.getFrameOffset(frame))){
+        return false;
+    }
+    return fread(pixels.getData(), 1, myHeader.frameSize, file) == myHeader.frameSize;
+}
+
+template<typename T>
+const ofPixels_<T>& ofxPixelBufferStream_<T>::getFrame(int index){
+    unique_lock<mutex> lock(myMutex);
+    bool waited = false;
+    while (true){
+        auto it = myFrameSlots.find(index);
+        if (it != myFrameSlots.end()){
+            int slot = it->second;
+            if (mySlots[slot].loading){
+                // the prefetch thread is just loading it
+                if (!waited){
+                    myStats.stalls++;
+                    waited = true;
+                }
+                myLoadCondition.wait(lock);
+                continue;
+            }
+            if (!waited){
+                myStats.hits++;
+            }
+            touch(slot);
+            myPins[myPinIndex] = index;
+            myPinIndex = (myPinIndex + 1) % numPins;
+            return mySlots[slot].pixels;
+        }
+        // miss: load it ourselves
+        int slot = findVictim(false);
+        if (slot < 0){
+            // every slot is busy, wait for the prefetch thread
+            myLoadCondition.wait(lock);
+            continue;
+        }
+        myStats.misses++;
+        if (!waited){
+            myStats.stalls++;
+        }
+        assignSlot(slot, index);
+        lock.unlock();
+        if (!readFrame(myReaderFile, index, mySlots[slot].pixels)){
+            cout << "couldn't read frame " << index << "!\n";
+        }
+        lock.lock();
+        mySlots[slot].loading = false;
+        myLoadCondition.notify_all();
+        touch(slot);
+        myPins[myPinIndex] = index;
+        myPinIndex = (myPinIndex + 1) % numPins;
+        return mySlots[slot].pixels;
+    }
+}
+
+template<typename T>
+void ofxPixelBufferStream_<T>::prefetch(const vector<int>& frames){
+    {
+        lock_guard<mutex> lock(myMutex);
+        myRequests.clear();
+        myWanted.clear();
+        for (int frame : frames){
+            if (frame >= 0 && static_cast<uint64_t>(frame) < myHeader.numFrames){
+                myRequests.push_back(frame);
+                myWanted.insert(frame);
+            }
+        }
+    }
+    myRequestCondition.notify_one();
+}
+
+template<typename T>
+void ofxPixelBufferStream_<T>::threadFunction(){
+    unique_lock<mutex> lock(myMutex);
+    while (!bQuit){
+        if (myRequests.empty()){
+            myRequestCondition.wait(lock);
+            continue;
+        }
+        int frame = myRequests.front();
+        myRequests.pop_front();
+        if (myFrameSlots.count(frame)){
+            continue; // already resident (or loading)
+        }
+        int slot = findVictim(true);
+        if (slot < 0){
+            // the cache is full of frames we still need, wait for the next request
+            myRequests.clear();
+            continue;
+        }
+        assignSlot(slot, frame);
+        lock.unlock();
+        bool success = readFrame(myPrefetchFile, frame, mySlots[slot].pixels);
+        lock.lock();
+        Slot& s = mySlots[slot];
+        s.loading = false;
+        if (success){
+            // counts as just used, so it isn't evicted right away
+            touch(slot);
+            myStats.prefetched++;
+        } else {
+            myFrameSlots.erase(frame);
+            s.frame = -1;
+        }
+        myLoadCondition.notify_all();
+    }
+}
+
+template<typename T>
+ofxPixelBufferStreamStats ofxPixelBufferStream_<T>::getStats() const {
+    lock_guard<mutex> lock(myMutex);
+    ofxPixelBufferStreamStats stats = myStats;
+    stats.resident = myFrameSlots.size();
+    stats.capacity = mySlots.size();
+    return stats;
+}
+
+template<typename T>
+void ofxPixelBufferStream_<T>::resetStats(){
+    lock_guard<mutex> lock(myMutex);
+    myStats.hits = 0;
+    myStats.misses = 0;
+    myStats.stalls = 0;
+    myStats.prefetched = 0;
+    myStats.evictions = 0;
+    myStats.resident = 0;
+    myStats.capacity = 0;
+}
+
+template class ofxPixelBufferStream_<unsigned char>;
+template class ofxPixelBufferStream_<unsigned short>;
+template class ofxPixelBufferStream_<float>;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxPixelBufferFile.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+struct ofxPixelBufferStreamStats {
+    uint64_t hits; // frame was resident
+    uint64_t misses; // frame had to be loaded on the reading thread
+    uint64_t stalls; // reads that had to wait for the disk (misses + prefetches that came too late)
+    uint64_t prefetched; // frames loaded by the prefetch thread
+    uint64_t evictions;
+    int resident; // frames currently in the cache
+    int capacity;
+};
+
+// streams the frames of a raw ofxPixelBuffer file (see ofxPixelBufferFile.h) through a bounded LRU cache.
+// a background thread loads the frames requested with prefetch().
+template<typename T>
+class ofxPixelBufferStream_ {
+    protected:
+        struct Slot {
+            ofPixels_<T> pixels;
+            int frame;
+            uint64_t lastUse;
+            bool loading;
+        };
+        static const int numPins = 4;
+
+        ofxPixelBufferFileHeader myHeader;
+        string myPath;
+        FILE* myReaderFile; // used by the reading thread
+        FILE* myPrefetchFile; // used by the prefetch thread
+        vector<Slot> mySlots;
+        unordered_map<int, int> myFrameSlots; // frame -> slot
+        int myPins[numPins]; // the most recently read frames are never evicted
+        int myPinIndex;
+        uint64_t myClock;
+        deque<int> myRequests; // frames to prefetch, most urgent first
+        unordered_set<int> myWanted; // all frames of the current prefetch request
+        ofxPixelBufferStreamStats myStats;
+
+        mutable mutex myMutex;
+        condition_variable myRequestCondition;
+        condition_variable myLoadCondition;
+        thread myThread;
+        bool bQuit;
+
+        bool isPinned(int frame) const;
+        int findVictim(bool prefetching) const;
+        void assignSlot(int slot, int frame);
+        void touch(int slot);
+        bool readFrame(FILE* file, int frame, ofPixels_<T>& pixels) const;
+        void threadFunction();
+    public:
+        ofxPixelBufferStream_();
+        ~ofxPixelBufferStream_();
+        ofxPixelBufferStream_(const ofxPixelBufferStream_<T>&) = delete;
+        ofxPixelBufferStream_<T>& operator= (const ofxPixelBufferStream_<T>&) = delete;
+
+        bool open(const string& filePath, int cacheFrames);
+        void close();
+        bool isOpen() const {return myReaderFile != nullptr;}
+        const ofxPixelBufferFileHeader& getHeader() const {return myHeader;}
+        const string& getPath() const {return myPath;}
+        int getCacheSize() const {return mySlots.size();}
+        // how many frames a prefetch request should cover
+        int getPrefetchDepth() const {return max(1, static_cast<int>(mySlots.size()) / 2 - numPins);}
+
+        // get a frame (blocks if it isn't resident). only call from one thread!
+        // the reference stays valid until at least 3 other frames have been read.
+        const ofPixels_<T>& getFrame(int index);
+        // replace the pending prefetch request
+        void prefetch(const vector<int>& frames);
+
+        ofxPixelBufferStreamStats getStats() const;
+        void resetStats();
+};
+
+typedef ofxPixelBufferStream_<unsigned char> ofxPixelBufferStream;